@@ -0,0 +1,43 @@
+#ifndef __NOSTDLIB_BITS_ALLOCATOR_H__
+#define __NOSTDLIB_BITS_ALLOCATOR_H__
+#include "uninitialized.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace std
+{
+    // The default allocator of the containers that take one, over detail::allocate; a custom allocator only needs
+    // value_type, allocate(n) and deallocate(p, n)
+    template <typename T>
+    struct allocator
+    {
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using is_always_equal = true_type;
+        using propagate_on_container_move_assignment = true_type;
+
+        constexpr allocator() noexcept = default;
+        template <typename U>
+        constexpr allocator(const allocator<U>&) noexcept
+        {
+        }
+
+        [[nodiscard]] T* allocate(size_t n) { return detail::allocate<T>(n); }
+        void deallocate(T* p, size_t) { detail::deallocate(p); }
+    };
+
+    template <typename T, typename U>
+    constexpr bool operator==(const allocator<T>&, const allocator<U>&) noexcept
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    constexpr bool operator!=(const allocator<T>&, const allocator<U>&) noexcept
+    {
+        return false;
+    }
+} // namespace std
+
+#endif
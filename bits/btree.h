@@ -0,0 +1,862 @@
+#ifndef __NOSTDLIB_BTREE_H__
+#define __NOSTDLIB_BTREE_H__
+#include "iterator_simple_types.h"
+#include "reverse_iterator.h"
+#include "uninitialized.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace std::detail
+{
+    // target size of a node; a lookup touches one node per level, so this trades tree height for the number of
+    // cache lines scanned per level
+    inline constexpr size_t BTREE_NODE_BYTES = 256;
+
+    // The untyped part of every node. position is the index of the node among its parent's children
+    struct btree_node_base
+    {
+        btree_node_base* parent;
+        uint16_t position;
+        uint16_t count;
+        bool is_leaf;
+    };
+
+    // leaves are linked in key order, so iteration and range scans never climb the tree
+    struct btree_leaf_base : btree_node_base
+    {
+        btree_leaf_base* prev;
+        btree_leaf_base* next;
+    };
+
+    template <typename Leaf, typename Value, bool Const>
+    class btree_iterator
+    {
+        template <typename, typename, typename, typename>
+        friend class btree;
+        template <typename, typename, bool>
+        friend class btree_iterator;
+
+        Leaf* node;
+        size_t pos;
+
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = Value;
+        using difference_type = ptrdiff_t;
+        using reference = conditional_t<Const, const Value&, Value&>;
+        using pointer = conditional_t<Const, const Value*, Value*>;
+
+        constexpr btree_iterator() noexcept : node(nullptr), pos(0) {}
+        btree_iterator(const Leaf* n, size_t p) noexcept : node((Leaf*)n), pos(p) {}
+        template <bool C, typename = enable_if_t<Const && !C>>
+        btree_iterator(const btree_iterator<Leaf, Value, C>& i) noexcept : node(i.node), pos(i.pos)
+        {
+        }
+
+        reference operator*() const noexcept { return node->values()[pos]; }
+        pointer operator->() const noexcept { return node->values() + pos; }
+
+        btree_iterator& operator++() noexcept
+        {
+            // the position past the last element of the last leaf is end()
+            if (++pos == node->count && node->next)
+            {
+                node = (Leaf*)node->next;
+                pos = 0;
+            }
+            return *this;
+        }
+
+        btree_iterator operator++(int) noexcept
+        {
+            btree_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        btree_iterator& operator--() noexcept
+        {
+            if (pos == 0)
+            {
+                node = (Leaf*)node->prev;
+                pos = node->count;
+            }
+            pos--;
+            return *this;
+        }
+
+        btree_iterator operator--(int) noexcept
+        {
+            btree_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const btree_iterator<Leaf, Value, C>& rhs) const noexcept
+        {
+            return node == rhs.node && pos == rhs.pos;
+        }
+
+        template <bool C>
+        bool operator!=(const btree_iterator<Leaf, Value, C>& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+    };
+
+    // A B+ tree of unique keys behind btree_map and btree_set. Values live in the leaves only; internal nodes hold
+    // copies of keys as separators, child i covering the keys in [keys[i - 1], keys[i]). Nodes are sized to
+    // BTREE_NODE_BYTES and searched linearly, which for arithmetic keys with less<> compiles to a branchless count.
+    // Inserting and erasing moves values between and within leaves, so both invalidate all iterators
+    template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+    class btree
+    {
+        using base = btree_node_base;
+
+        static constexpr size_t clamp(size_t v, size_t lo, size_t hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+        static constexpr size_t LEAF_SLOTS =
+            clamp((BTREE_NODE_BYTES - sizeof(btree_leaf_base)) / sizeof(Value), 4, UINT16_MAX);
+        static constexpr size_t INTERNAL_KEYS =
+            clamp((BTREE_NODE_BYTES - sizeof(base) - sizeof(base*)) / (sizeof(Key) + sizeof(base*)), 3, UINT16_MAX - 1);
+
+        // a node other than the root with fewer entries borrows from or merges with a sibling
+        static constexpr size_t LEAF_MIN = LEAF_SLOTS / 2;
+        static constexpr size_t INTERNAL_MIN = INTERNAL_KEYS / 2;
+
+        struct leaf : btree_leaf_base
+        {
+            alignas(Value) unsigned char storage[sizeof(Value) * LEAF_SLOTS];
+            Value* values() { return (Value*)storage; }
+        };
+
+        struct internal : btree_node_base
+        {
+            base* children[INTERNAL_KEYS + 1];
+            alignas(Key) unsigned char storage[sizeof(Key) * INTERNAL_KEYS];
+            Key* keys() { return (Key*)storage; }
+        };
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using key_compare = Compare;
+        // set elements are their own keys and stay const
+        using iterator = btree_iterator<leaf, Value, is_same_v<Key, Value>>;
+        using const_iterator = btree_iterator<leaf, Value, true>;
+
+    private:
+        base* root;
+        leaf* first;
+        leaf* last;
+        size_t s;
+        Compare cmp;
+
+        static const Key& key_of(const Value& v) { return KeyOfValue()(v); }
+
+        // counting every entry instead of stopping at the first greater one has no data dependent branch, and
+        // vectorizes for plain numbers
+        template <typename K>
+        static constexpr bool count_all =
+            is_arithmetic_v<Key> && is_same_v<K, Key> && (is_same_v<Compare, less<Key>> || is_same_v<Compare, less<>>);
+
+        // the number of entries of a node that go before k: the ones less than k, or for Upper the ones not greater
+        template <bool Upper, bool Leaf, typename T, typename K>
+        size_t rank(const T* entries, size_t n, const K& k) const
+        {
+            auto before = [&](const T& e) {
+                const Key& ek = [&]() -> const Key& {
+                    if constexpr (Leaf)
+                        return key_of(e);
+                    else
+                        return e;
+                }();
+                if constexpr (Upper)
+                    return !cmp(k, ek);
+                else
+                    return cmp(ek, k);
+            };
+
+            if constexpr (count_all<K>)
+            {
+                size_t r = 0;
+                for (size_t i = 0; i < n; i++)
+                    r += before(entries[i]);
+                return r;
+            }
+            else
+            {
+                size_t i = 0;
+                while (i < n && before(entries[i]))
+                    i++;
+                return i;
+            }
+        }
+
+        // the leaf that covers k and the rank of k in it, which may be past its last element
+        template <bool Upper, typename K>
+        iterator descend(const K& k) const
+        {
+            base* n = root;
+            while (!n->is_leaf)
+            {
+                internal* in = (internal*)n;
+                n = in->children[rank<Upper, false>(in->keys(), in->count, k)];
+            }
+
+            leaf* l = (leaf*)n;
+            return iterator(l, rank<Upper, true>(l->values(), l->count, k));
+        }
+
+        // turns a slot past the end of a leaf into the first element of the next one
+        static iterator normalize(leaf* n, size_t pos)
+        {
+            if (pos == n->count && n->next)
+                return iterator((leaf*)n->next, 0);
+            return iterator(n, pos);
+        }
+
+        static leaf* new_leaf()
+        {
+            leaf* n = ::new ((void*)detail::allocate<leaf>(1)) leaf;
+            n->parent = nullptr;
+            n->position = n->count = 0;
+            n->is_leaf = true;
+            n->prev = n->next = nullptr;
+            return n;
+        }
+
+        static internal* new_internal()
+        {
+            internal* n = ::new ((void*)detail::allocate<internal>(1)) internal;
+            n->parent = nullptr;
+            n->position = n->count = 0;
+            n->is_leaf = false;
+            return n;
+        }
+
+        static void set_child(internal* p, size_t i, base* c)
+        {
+            p->children[i] = c;
+            c->parent = p;
+            c->position = i;
+        }
+
+        // links r into the leaf list right after n
+        void link_after(leaf* n, leaf* r)
+        {
+            r->prev = n;
+            r->next = n->next;
+            if (n->next)
+                n->next->prev = r;
+            else
+                last = r;
+            n->next = r;
+        }
+
+        void unlink(leaf* n)
+        {
+            if (n->prev)
+                n->prev->next = n->next;
+            else
+                first = (leaf*)n->next;
+            if (n->next)
+                n->next->prev = n->prev;
+            else
+                last = (leaf*)n->prev;
+        }
+
+        void drop(base* n)
+        {
+            if (n->is_leaf)
+            {
+                leaf* l = (leaf*)n;
+                std::destroy_n(l->values(), l->count);
+                detail::deallocate(l);
+            }
+            else
+            {
+                internal* in = (internal*)n;
+                std::destroy_n(in->keys(), in->count);
+                for (size_t i = 0; i <= in->count; i++)
+                    drop(in->children[i]);
+                detail::deallocate(in);
+            }
+        }
+
+        // copies the subtree x below parent, appending its leaves to the leaf list
+        base* clone(const base* x, internal* parent)
+        {
+            base* y;
+            if (x->is_leaf)
+            {
+                leaf* l = new_leaf();
+                std::uninitialized_copy_n(((leaf*)x)->values(), x->count, l->values());
+                l->prev = last;
+                if (last)
+                    last->next = l;
+                else
+                    first = l;
+                last = l;
+                y = l;
+            }
+            else
+            {
+                internal* in = new_internal();
+                std::uninitialized_copy_n(((internal*)x)->keys(), x->count, in->keys());
+                for (size_t i = 0; i <= x->count; i++)
+                    set_child(in, i, clone(((internal*)x)->children[i], in));
+                y = in;
+            }
+
+            y->parent = parent;
+            y->count = x->count;
+            return y;
+        }
+
+        void steal(btree& other)
+        {
+            root = other.root;
+            first = other.first;
+            last = other.last;
+            s = other.s;
+            other.root = other.first = other.last = nullptr;
+            other.s = 0;
+        }
+
+        // adds key k and child c right of it at index i of p, which has room for them
+        static void insert_entry(internal* p, size_t i, Key&& k, base* c)
+        {
+            Key* keys = p->keys();
+            detail::relocate_backward(keys + i + 1, keys + i, p->count - i);
+            construct_at(keys + i, std::move(k));
+            for (size_t j = p->count + 1; j > i + 1; j--)
+                set_child(p, j, p->children[j - 1]);
+            set_child(p, i + 1, c);
+            p->count++;
+        }
+
+        // removes key i of p and the child right of it
+        static void remove_entry(internal* p, size_t i)
+        {
+            Key* keys = p->keys();
+            destroy_at(keys + i);
+            detail::relocate(keys + i, keys + i + 1, p->count - i - 1);
+            for (size_t j = i + 1; j < p->count; j++)
+                set_child(p, j, p->children[j + 1]);
+            p->count--;
+        }
+
+        // makes right, split off left, a sibling of left separated by sep, splitting the parents as needed.
+        // append means the split happened at the right edge of the tree; the left nodes are then kept full, so
+        // ascending inserts leave a packed tree behind
+        void insert_into_parent(base* left, Key&& sep, base* right, bool append)
+        {
+            internal* p = (internal*)left->parent;
+            if (!p)
+            {
+                p = new_internal();
+                construct_at(p->keys(), std::move(sep));
+                p->count = 1;
+                set_child(p, 0, left);
+                set_child(p, 1, right);
+                root = p;
+                return;
+            }
+
+            size_t i = left->position;
+            if (p->count < INTERNAL_KEYS)
+            {
+                insert_entry(p, i, std::move(sep), right);
+                return;
+            }
+
+            // of the INTERNAL_KEYS + 1 keys including sep, the first m stay, the next goes up and the rest move to q
+            constexpr size_t K = INTERNAL_KEYS;
+            size_t m = append && i == K ? K - 1 : (K + 1) / 2;
+            internal* q = new_internal();
+            Key* keys = p->keys();
+
+            if (i == m)
+            {
+                detail::relocate(q->keys(), keys + m, K - m);
+                set_child(q, 0, right);
+                for (size_t j = m + 1; j <= K; j++)
+                    set_child(q, j - m, p->children[j]);
+                p->count = m;
+                q->count = K - m;
+                insert_into_parent(p, std::move(sep), q, append);
+                return;
+            }
+
+            size_t up_index = i < m ? m - 1 : m;
+            Key up(std::move(keys[up_index]));
+            destroy_at(keys + up_index);
+
+            detail::relocate(q->keys(), keys + up_index + 1, K - up_index - 1);
+            for (size_t j = up_index + 1; j <= K; j++)
+                set_child(q, j - up_index - 1, p->children[j]);
+            p->count = up_index;
+            q->count = K - up_index - 1;
+
+            if (i < m)
+                insert_entry(p, i, std::move(sep), right);
+            else
+                insert_entry(q, i - m - 1, std::move(sep), right);
+            insert_into_parent(p, std::move(up), q, append);
+        }
+
+        // moves *v into slot pos of leaf n, splitting it if it is full
+        iterator place(leaf* n, size_t pos, Value* v)
+        {
+            s++;
+            if (n->count < LEAF_SLOTS)
+            {
+                detail::relocate_backward(n->values() + pos + 1, n->values() + pos, n->count - pos);
+                detail::relocate(n->values() + pos, v, 1);
+                n->count++;
+                return iterator(n, pos);
+            }
+
+            bool append = n == last && pos == n->count;
+            leaf* r = new_leaf();
+            link_after(n, r);
+
+            leaf* target = n;
+            size_t keep = LEAF_MIN;
+            if (append || pos > LEAF_MIN)
+            {
+                keep = append ? LEAF_SLOTS : LEAF_MIN + 1;
+                target = r;
+                pos -= keep;
+            }
+
+            detail::relocate(r->values(), n->values() + keep, LEAF_SLOTS - keep);
+            n->count = keep;
+            r->count = LEAF_SLOTS - keep;
+
+            Value* vals = target->values();
+            detail::relocate_backward(vals + pos + 1, vals + pos, target->count - pos);
+            detail::relocate(vals + pos, v, 1);
+            target->count++;
+
+            insert_into_parent(n, Key(key_of(r->values()[0])), r, append);
+            return iterator(target, pos);
+        }
+
+        // restores the minimum fill of a leaf after an erase at pos and returns the element that followed it
+        iterator rebalance_leaf(leaf* n, size_t pos)
+        {
+            if (n == root)
+            {
+                if (n->count)
+                    return normalize(n, pos);
+
+                detail::deallocate(n);
+                root = first = last = nullptr;
+                return end();
+            }
+
+            if (n->count >= LEAF_MIN)
+                return normalize(n, pos);
+
+            internal* p = (internal*)n->parent;
+            size_t i = n->position;
+            leaf* l = i ? (leaf*)p->children[i - 1] : nullptr;
+            leaf* r = i < p->count ? (leaf*)p->children[i + 1] : nullptr;
+            Value* vals = n->values();
+
+            if (l && l->count > LEAF_MIN)
+            {
+                detail::relocate_backward(vals + 1, vals, n->count);
+                detail::relocate(vals, l->values() + --l->count, 1);
+                n->count++;
+                p->keys()[i - 1] = key_of(vals[0]);
+                return normalize(n, pos + 1);
+            }
+
+            if (r && r->count > LEAF_MIN)
+            {
+                detail::relocate(vals + n->count++, r->values(), 1);
+                detail::relocate(r->values(), r->values() + 1, --r->count);
+                p->keys()[i] = key_of(r->values()[0]);
+                return normalize(n, pos);
+            }
+
+            if (l)
+            {
+                pos += l->count;
+                merge_leaves(l, n);
+                n = l;
+                remove_entry(p, i - 1);
+            }
+            else
+            {
+                merge_leaves(n, r);
+                remove_entry(p, i);
+            }
+
+            rebalance_internal(p);
+            return normalize(n, pos);
+        }
+
+        void merge_leaves(leaf* a, leaf* b)
+        {
+            detail::relocate(a->values() + a->count, b->values(), b->count);
+            a->count += b->count;
+            unlink(b);
+            detail::deallocate(b);
+        }
+
+        void rebalance_internal(internal* p)
+        {
+            while (p != root && p->count < INTERNAL_MIN)
+            {
+                internal* g = (internal*)p->parent;
+                size_t i = p->position;
+                internal* l = i ? (internal*)g->children[i - 1] : nullptr;
+                internal* r = i < g->count ? (internal*)g->children[i + 1] : nullptr;
+
+                if (l && l->count > INTERNAL_MIN)
+                {
+                    // rotate the last child of l over to p through the separator in g
+                    Key* keys = p->keys();
+                    detail::relocate_backward(keys + 1, keys, p->count);
+                    construct_at(keys, std::move(g->keys()[i - 1]));
+                    g->keys()[i - 1] = std::move(l->keys()[l->count - 1]);
+                    destroy_at(l->keys() + l->count - 1);
+                    for (size_t j = p->count + 1; j > 0; j--)
+                        set_child(p, j, p->children[j - 1]);
+                    set_child(p, 0, l->children[l->count]);
+                    l->count--;
+                    p->count++;
+                    return;
+                }
+
+                if (r && r->count > INTERNAL_MIN)
+                {
+                    construct_at(p->keys() + p->count, std::move(g->keys()[i]));
+                    set_child(p, p->count + 1, r->children[0]);
+                    p->count++;
+                    g->keys()[i] = std::move(r->keys()[0]);
+                    destroy_at(r->keys());
+                    detail::relocate(r->keys(), r->keys() + 1, r->count - 1);
+                    for (size_t j = 0; j < r->count; j++)
+                        set_child(r, j, r->children[j + 1]);
+                    r->count--;
+                    return;
+                }
+
+                if (l)
+                    merge_internal(l, p, i - 1);
+                else
+                    merge_internal(p, r, i);
+                p = g;
+            }
+
+            if (p == root && !p->count)
+            {
+                root = p->children[0];
+                root->parent = nullptr;
+                detail::deallocate(p);
+            }
+        }
+
+        // appends the separator at index i of the parent and all of b to a, and frees b
+        static void merge_internal(internal* a, internal* b, size_t i)
+        {
+            internal* g = (internal*)a->parent;
+            construct_at(a->keys() + a->count, std::move(g->keys()[i]));
+            detail::relocate(a->keys() + a->count + 1, b->keys(), b->count);
+            for (size_t j = 0; j <= b->count; j++)
+                set_child(a, a->count + 1 + j, b->children[j]);
+            a->count += b->count + 1;
+            remove_entry(g, i);
+            detail::deallocate(b);
+        }
+
+    public:
+        explicit btree(const Compare& c = Compare()) : root(nullptr), first(nullptr), last(nullptr), s(0), cmp(c) {}
+
+        btree(const btree& other) : btree(other.cmp)
+        {
+            if (other.root)
+                root = clone(other.root, nullptr);
+            s = other.s;
+        }
+
+        btree(btree&& other) : btree(other.cmp) { steal(other); }
+
+        ~btree() { clear(); }
+
+        btree& operator=(const btree& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                cmp = other.cmp;
+                if (other.root)
+                    root = clone(other.root, nullptr);
+                s = other.s;
+            }
+            return *this;
+        }
+
+        btree& operator=(btree&& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                cmp = other.cmp;
+                steal(other);
+            }
+            return *this;
+        }
+
+        iterator begin() { return s ? iterator(first, 0) : iterator(); }
+        iterator end() { return s ? iterator(last, last->count) : iterator(); }
+        const_iterator begin() const { return s ? const_iterator(first, 0) : const_iterator(); }
+        const_iterator end() const { return s ? const_iterator(last, last->count) : const_iterator(); }
+
+        [[nodiscard]] bool empty() const noexcept { return s == 0; }
+        size_type size() const noexcept { return s; }
+        size_type max_size() const noexcept { return (size_type)-1 / sizeof(Value); }
+        key_compare key_comp() const { return cmp; }
+
+        void clear()
+        {
+            if (root)
+                drop(root);
+            root = first = last = nullptr;
+            s = 0;
+        }
+
+        void swap(btree& other)
+        {
+            btree tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        // The slot a new element with key k goes into, or the element with that key. Together with emplace_slot
+        // this lets btree_map::try_emplace construct the value only once it knows the key is new
+        template <typename K>
+        pair<iterator, bool> find_slot(const K& k)
+        {
+            if (!root)
+            {
+                root = first = last = new_leaf();
+                return {iterator(first, 0), false};
+            }
+
+            // to the right of equal separators, and then the only possible match is the element before the slot
+            iterator slot = descend<true>(k);
+            iterator prev = slot;
+            if (slot.pos || slot.node->prev)
+            {
+                --prev;
+                if (!cmp(key_of(*prev), k))
+                    return {prev, true};
+            }
+            return {slot, false};
+        }
+
+        // same, but O(1) when the key goes at the very front or back and the hint says so
+        template <typename K>
+        pair<iterator, bool> find_slot(const_iterator hint, const K& k)
+        {
+            if (s && hint == end() && cmp(key_of(last->values()[last->count - 1]), k))
+                return {iterator(last, last->count), false};
+            if (s && hint == begin() && cmp(k, key_of(first->values()[0])))
+                return {iterator(first, 0), false};
+            return find_slot(k);
+        }
+
+        template <typename... Args>
+        iterator emplace_slot(iterator slot, Args&&... args)
+        {
+            // built outside the tree first, args may refer to elements that the insert moves
+            alignas(Value) unsigned char buffer[sizeof(Value)];
+            Value* v = construct_at((Value*)buffer, std::forward<Args>(args)...);
+            return place(slot.node, slot.pos, v);
+        }
+
+        template <typename V>
+        pair<iterator, bool> insert(V&& v)
+        {
+            auto [slot, found] = find_slot(key_of(v));
+            if (found)
+                return {slot, false};
+            return {emplace_slot(slot, std::forward<V>(v)), true};
+        }
+
+        template <typename V>
+        iterator insert(const_iterator hint, V&& v)
+        {
+            auto [slot, found] = find_slot(hint, key_of(v));
+            if (found)
+                return slot;
+            return emplace_slot(slot, std::forward<V>(v));
+        }
+
+        // builds the value before looking for its key, which is what emplace has to do
+        template <typename... Args>
+        pair<iterator, bool> emplace(Args&&... args)
+        {
+            alignas(Value) unsigned char buffer[sizeof(Value)];
+            Value* v = construct_at((Value*)buffer, std::forward<Args>(args)...);
+            auto [slot, found] = find_slot(key_of(*v));
+            if (found)
+            {
+                destroy_at(v);
+                return {slot, false};
+            }
+            return {place(slot.node, slot.pos, v), true};
+        }
+
+        template <typename... Args>
+        iterator emplace_hint(const_iterator hint, Args&&... args)
+        {
+            alignas(Value) unsigned char buffer[sizeof(Value)];
+            Value* v = construct_at((Value*)buffer, std::forward<Args>(args)...);
+            auto [slot, found] = find_slot(hint, key_of(*v));
+            if (found)
+            {
+                destroy_at(v);
+                return slot;
+            }
+            return place(slot.node, slot.pos, v);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            leaf* n = pos.node;
+            Value* vals = n->values();
+            destroy_at(vals + pos.pos);
+            detail::relocate(vals + pos.pos, vals + pos.pos + 1, n->count - pos.pos - 1);
+            n->count--;
+            s--;
+            return rebalance_leaf(n, pos.pos);
+        }
+
+        iterator erase(const_iterator first_, const_iterator last_)
+        {
+            if (first_ == begin() && last_ == end())
+            {
+                clear();
+                return end();
+            }
+
+            // every erase may move the elements around last_, so count them first
+            size_t n = 0;
+            for (const_iterator it = first_; it != last_; ++it)
+                n++;
+
+            iterator it(first_.node, first_.pos);
+            for (; n; n--)
+                it = erase(it);
+            return it;
+        }
+
+        template <typename K>
+        size_type erase_key(const K& k)
+        {
+            iterator it = find(k);
+            if (it == end())
+                return 0;
+            erase(it);
+            return 1;
+        }
+
+        template <typename K>
+        iterator lower_bound(const K& k)
+        {
+            if (!root)
+                return end();
+            iterator it = descend<false>(k);
+            return normalize(it.node, it.pos);
+        }
+
+        template <typename K>
+        const_iterator lower_bound(const K& k) const
+        {
+            return ((btree*)this)->lower_bound(k);
+        }
+
+        template <typename K>
+        iterator upper_bound(const K& k)
+        {
+            if (!root)
+                return end();
+            iterator it = descend<true>(k);
+            return normalize(it.node, it.pos);
+        }
+
+        template <typename K>
+        const_iterator upper_bound(const K& k) const
+        {
+            return ((btree*)this)->upper_bound(k);
+        }
+
+        template <typename K>
+        iterator find(const K& k)
+        {
+            iterator it = lower_bound(k);
+            return it == end() || cmp(k, key_of(*it)) ? end() : it;
+        }
+
+        template <typename K>
+        const_iterator find(const K& k) const
+        {
+            return ((btree*)this)->find(k);
+        }
+
+        template <typename K>
+        pair<iterator, iterator> equal_range(const K& k)
+        {
+            iterator it = find(k);
+            if (it == end())
+                return {it, it};
+            iterator next = it;
+            return {it, ++next};
+        }
+
+        template <typename K>
+        pair<const_iterator, const_iterator> equal_range(const K& k) const
+        {
+            return ((btree*)this)->equal_range(k);
+        }
+
+        template <typename K>
+        size_type count(const K& k) const
+        {
+            return find(k) != end();
+        }
+
+        // moves the elements of other whose keys are not present here over to this tree
+        template <typename C2>
+        void merge(btree<Key, Value, KeyOfValue, C2>& other)
+        {
+            for (auto it = other.begin(); it != other.end();)
+            {
+                auto [slot, found] = find_slot(key_of(*it));
+                if (found)
+                {
+                    ++it;
+                    continue;
+                }
+
+                emplace_slot(slot, std::move(*it));
+                it = other.erase(it);
+            }
+        }
+    };
+} // namespace std::detail
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __NOSTDLIB_BITS_CHAR_TRAITS_H__
+#define __NOSTDLIB_BITS_CHAR_TRAITS_H__
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace std
+{
+    template <typename CharT>
+    struct char_traits
+    {
+        using char_type = CharT;
+        using int_type = conditional_t<(sizeof(CharT) < sizeof(int)), int, long long>;
+
+        static constexpr void assign(char_type& r, const char_type& a) noexcept { r = a; }
+        static constexpr bool eq(char_type a, char_type b) noexcept { return a == b; }
+        static constexpr bool lt(char_type a, char_type b) noexcept { return a < b; }
+
+        static constexpr int compare(const char_type* s1, const char_type* s2, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                if (lt(s1[i], s2[i]))
+                    return -1;
+                if (lt(s2[i], s1[i]))
+                    return 1;
+            }
+            return 0;
+        }
+
+        static constexpr size_t length(const char_type* s)
+        {
+            size_t n = 0;
+            while (!eq(s[n], char_type()))
+                n++;
+            return n;
+        }
+
+        static constexpr const char_type* find(const char_type* s, size_t n, const char_type& c)
+        {
+            for (size_t i = 0; i < n; i++)
+                if (eq(s[i], c))
+                    return s + i;
+            return nullptr;
+        }
+
+        static constexpr char_type* move(char_type* dest, const char_type* src, size_t n)
+        {
+            if (dest < src)
+                for (size_t i = 0; i < n; i++)
+                    dest[i] = src[i];
+            else
+                for (size_t i = n; i-- > 0;)
+                    dest[i] = src[i];
+            return dest;
+        }
+
+        static constexpr char_type* copy(char_type* dest, const char_type* src, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                dest[i] = src[i];
+            return dest;
+        }
+
+        static constexpr char_type* assign(char_type* s, size_t n, char_type a)
+        {
+            for (size_t i = 0; i < n; i++)
+                s[i] = a;
+            return s;
+        }
+
+        static constexpr char_type to_char_type(int_type c) noexcept { return (char_type)c; }
+        static constexpr int_type to_int_type(char_type c) noexcept { return (int_type)c; }
+        static constexpr bool eq_int_type(int_type a, int_type b) noexcept { return a == b; }
+        static constexpr int_type eof() noexcept { return -1; }
+        static constexpr int_type not_eof(int_type c) noexcept { return c == eof() ? 0 : c; }
+    };
+
+    // char goes through the cstring kernels, except in constant evaluation; characters compare as unsigned char
+    template <>
+    struct char_traits<char>
+    {
+        using char_type = char;
+        using int_type = int;
+
+        static constexpr void assign(char_type& r, const char_type& a) noexcept { r = a; }
+        static constexpr bool eq(char_type a, char_type b) noexcept { return a == b; }
+        static constexpr bool lt(char_type a, char_type b) noexcept { return (unsigned char)a < (unsigned char)b; }
+
+        static constexpr int compare(const char_type* s1, const char_type* s2, size_t n)
+        {
+            if (!__builtin_is_constant_evaluated())
+                return memcmp(s1, s2, n);
+
+            for (size_t i = 0; i < n; i++)
+                if (s1[i] != s2[i])
+                    return lt(s1[i], s2[i]) ? -1 : 1;
+            return 0;
+        }
+
+        static constexpr size_t length(const char_type* s)
+        {
+            if (!__builtin_is_constant_evaluated())
+                return strlen(s);
+
+            size_t n = 0;
+            while (s[n])
+                n++;
+            return n;
+        }
+
+        static constexpr const char_type* find(const char_type* s, size_t n, const char_type& c)
+        {
+            if (!__builtin_is_constant_evaluated())
+                return (const char_type*)memchr(s, c, n);
+
+            for (size_t i = 0; i < n; i++)
+                if (s[i] == c)
+                    return s + i;
+            return nullptr;
+        }
+
+        static char_type* move(char_type* dest, const char_type* src, size_t n)
+        {
+            return (char_type*)memmove(dest, src, n);
+        }
+
+        static char_type* copy(char_type* dest, const char_type* src, size_t n)
+        {
+            return (char_type*)memcpy(dest, src, n);
+        }
+
+        static char_type* assign(char_type* s, size_t n, char_type a) { return (char_type*)memset(s, a, n); }
+
+        static constexpr char_type to_char_type(int_type c) noexcept { return (char_type)c; }
+        static constexpr int_type to_int_type(char_type c) noexcept { return (unsigned char)c; }
+        static constexpr bool eq_int_type(int_type a, int_type b) noexcept { return a == b; }
+        static constexpr int_type eof() noexcept { return -1; }
+        static constexpr int_type not_eof(int_type c) noexcept { return c == eof() ? 0 : c; }
+    };
+} // namespace std
+
+#endif
@@ -1,13 +1,21 @@
 #ifndef __NOSTDLIB_BITS__DEQUE_H__
 #define __NOSTDLIB_BITS__DEQUE_H__
 
-#include "emptiable_storage.h"
+#include "iterator_simple_types.h"
+#include "reverse_iterator.h"
+#include "uninitialized.h"
+#include "user_implement.h"
 #include "utils.h"
 #include <initializer_list>
-#include <vector>
+#include <utility>
 
 namespace std
 {
+    // Elements live in fixed size blocks, which are never moved once allocated, so references stay valid across
+    // push_front/push_back. The block map is a power of two ring of block pointers: growing at either end only
+    // moves the ring head, and the map itself is only reallocated when every slot is in use.
+    // Up to MAX_SPARE blocks that fall off either end are kept on a free list and handed out again before allocating,
+    // so a queue that keeps crossing a block boundary does not allocate on every crossing.
     template <typename T>
     class deque
     {
@@ -20,251 +28,257 @@ namespace std
         using pointer = T*;
         using const_pointer = const T*;
 
-        inline static constexpr size_t PREALLOCATE_COUNT = 3;
-        inline static constexpr size_t BLOCK_SIZE = 64;
+        // blocks target this many bytes, but hold at least MIN_BLOCK_SIZE elements unless that takes more than
+        // MAX_BLOCK_BYTES, so large elements get small blocks rather than a block far bigger than the deque. The
+        // element count is rounded down to a power of two so indexing is a shift and a mask
+        inline static constexpr size_t BLOCK_BYTES = 512;
+        inline static constexpr size_t MAX_BLOCK_BYTES = 4096;
+        inline static constexpr size_t MIN_BLOCK_SIZE = 16;
+        inline static constexpr size_t BLOCK_FLOOR =
+            detail::max(detail::min(MIN_BLOCK_SIZE, MAX_BLOCK_BYTES / sizeof(T)), size_t(1));
+        inline static constexpr size_t BLOCK_SIZE =
+            size_t(1) << (63 - __builtin_clzll(detail::max(BLOCK_BYTES / sizeof(T), BLOCK_FLOOR)));
+        inline static constexpr size_t BLOCK_SHIFT = __builtin_ctzll(BLOCK_SIZE);
+        inline static constexpr size_t MAX_SPARE = 2;
 
     private:
-        using deque_node = detail::emptiable_array<T, BLOCK_SIZE>;
-
-        vector<deque_node*> buf;
-        size_t first_offset, s;
+        T** map;
+        size_t map_cap;
+        size_t map_head;
+        size_t blocks;
+        // offset of the first element inside the first block
+        size_t first;
+        size_t s;
+        // singly linked through the first word of each block, at most MAX_SPARE long
+        void* spare;
+        size_t spare_count;
+
+        T* block(size_t n) const { return map[(map_head + n) & (map_cap - 1)]; }
+
+        T* slot(size_t pos) const
+        {
+            size_t k = first + pos;
+            return block(k >> BLOCK_SHIFT) + (k & (BLOCK_SIZE - 1));
+        }
 
-    public:
-        class iterator
+        T* take_block()
         {
-            deque* dq;
-            size_t index;
-        public:
-            using iterator_category = std::random_access_iterator_tag;
-            using value_type = T;
-            using difference_type = ptrdiff_t;
-            using reference = T&;
-            using pointer = T*;
-
-            constexpr iterator() noexcept : dq(nullptr), index(0) {}
-            explicit iterator(const iterator& i) noexcept : dq(i.n), index(i.index) {}
-            iterator(deque* n, size_t i) noexcept : dq(n), index(i) {}
-
-            reference operator*() const noexcept { return *dq[index]; }
-            pointer operator->() const noexcept { return &(*dq[index]); }
-            reference operator[](difference_type n) const noexcept { return *dq[index + n]; }
-            
-            iterator& operator++() noexcept
-            {
-                ++index;
-                return *this;
-            }
+            if (!spare)
+                return detail::allocate<T>(BLOCK_SIZE);
 
-            iterator operator++(int) noexcept { return iterator(dq, index++); }
+            void* b = spare;
+            spare = *(void**)b;
+            spare_count--;
+            return (T*)b;
+        }
 
-            iterator& operator--() noexcept
-            {
-                --index;
-                return *this;
-            }
+        void recycle_block(T* b)
+        {
+            if (spare_count == MAX_SPARE)
+                return detail::deallocate(b);
 
-            iterator operator--(int) noexcept { return iterator(dq, index--); }
+            *(void**)b = spare;
+            spare = b;
+            spare_count++;
+        }
 
-            iterator& operator+=(difference_type n) noexcept
-            {
-                index += n;
-                return *this;
-            }
+        // makes room for at least one more block in the map, unwrapping the ring to the start of the new map
+        void reserve_map()
+        {
+            if (blocks < map_cap)
+                return;
+
+            size_t new_cap = map_cap ? map_cap << 1 : 8;
+            T** m = detail::allocate<T*>(new_cap);
+            for (size_t i = 0; i < blocks; i++)
+                m[i] = block(i);
+
+            detail::deallocate(map);
+            map = m;
+            map_cap = new_cap;
+            map_head = 0;
+        }
 
-            iterator& operator-=(difference_type n) noexcept
+        // hands blocks that no longer hold any element back to the free list
+        void trim()
+        {
+            if (s == 0)
             {
-                index -= n;
-                return *this;
+                for (; blocks; blocks--)
+                    recycle_block(block(blocks - 1));
+                first = 0;
+                return;
             }
 
-            iterator operator+(difference_type n) const noexcept { return iterator(dq, index + n); }
-            iterator operator-(difference_type n) const noexcept { return iterator(dq, index - n); }
-        };
+            size_t used = ((first + s - 1) >> BLOCK_SHIFT) + 1;
+            for (; blocks > used; blocks--)
+                recycle_block(block(blocks - 1));
+        }
+
+        void free_spare()
+        {
+            while (spare)
+                detail::deallocate(take_block());
+        }
 
-        class const_iterator
+        template <typename D, typename V>
+        class iterator_impl
         {
-            deque* dq;
+            friend class deque;
+            template <typename, typename>
+            friend class iterator_impl;
+
+            D* dq;
             size_t index;
+
         public:
-            using iterator_category = std::random_access_iterator_tag;
-            using value_type = const T;
+            using iterator_category = random_access_iterator_tag;
+            using value_type = T;
             using difference_type = ptrdiff_t;
-            using reference = const T&;
-            using pointer = const T*;
+            using reference = V&;
+            using pointer = V*;
 
-            constexpr const_iterator() noexcept : dq(nullptr), index(0) {}
-            explicit const_iterator(const const_iterator& i) noexcept : dq(i.n), index(i.index) {}
-            const_iterator(deque* n, size_t i) noexcept : dq(n), index(i) {}
+            constexpr iterator_impl() noexcept : dq(nullptr), index(0) {}
+            iterator_impl(D* d, size_t i) noexcept : dq(d), index(i) {}
+            template <typename D2, typename V2, typename = enable_if_t<is_convertible_v<V2*, V*>>>
+            iterator_impl(const iterator_impl<D2, V2>& i) noexcept : dq(i.dq), index(i.index)
+            {
+            }
 
-            reference operator*() const noexcept { return *dq[index]; }
-            pointer operator->() const noexcept { return &(*dq[index]); }
-            reference operator[](difference_type n) const noexcept { return *dq[index + n]; }
+            reference operator*() const noexcept { return *dq->slot(index); }
+            pointer operator->() const noexcept { return dq->slot(index); }
+            reference operator[](difference_type n) const noexcept { return *dq->slot(index + n); }
 
-            const_iterator& operator++() noexcept
+            iterator_impl& operator++() noexcept
             {
                 ++index;
                 return *this;
             }
 
-            const_iterator operator++(int) noexcept { return const_iterator(dq, index++); }
+            iterator_impl operator++(int) noexcept { return iterator_impl(dq, index++); }
 
-            const_iterator& operator--() noexcept
+            iterator_impl& operator--() noexcept
             {
                 --index;
                 return *this;
             }
 
-            const_iterator operator--(int) noexcept { return const_iterator(dq, index--); }
+            iterator_impl operator--(int) noexcept { return iterator_impl(dq, index--); }
 
-            const_iterator& operator+=(difference_type n) noexcept
+            iterator_impl& operator+=(difference_type n) noexcept
             {
                 index += n;
                 return *this;
             }
 
-            const_iterator& operator-=(difference_type n) noexcept
+            iterator_impl& operator-=(difference_type n) noexcept
             {
                 index -= n;
                 return *this;
             }
 
-            const_iterator operator+(difference_type n) const noexcept { return const_iterator(dq, index + n); }
-            const_iterator operator-(difference_type n) const noexcept { return const_iterator(dq, index - n); }
+            iterator_impl operator+(difference_type n) const noexcept { return iterator_impl(dq, index + n); }
+            iterator_impl operator-(difference_type n) const noexcept { return iterator_impl(dq, index - n); }
+            difference_type operator-(const iterator_impl& rhs) const noexcept { return index - rhs.index; }
+
+            bool operator==(const iterator_impl& rhs) const noexcept { return index == rhs.index; }
+            bool operator!=(const iterator_impl& rhs) const noexcept { return index != rhs.index; }
+            bool operator<(const iterator_impl& rhs) const noexcept { return index < rhs.index; }
+            bool operator>(const iterator_impl& rhs) const noexcept { return index > rhs.index; }
+            bool operator<=(const iterator_impl& rhs) const noexcept { return index <= rhs.index; }
+            bool operator>=(const iterator_impl& rhs) const noexcept { return index >= rhs.index; }
         };
 
+    public:
+        using iterator = iterator_impl<deque, T>;
+        using const_iterator = iterator_impl<const deque, const T>;
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        constexpr deque() : buf(), first_offset(0){};
-
-        deque(size_type count, const T& value) { assign(count, value); }
-
-        explicit deque(size_type count)
-        {
-            s = count;
-            first_offset = 64 * PREALLOCATE_COUNT;
-
-            buf.reserve(((count + 63) / 64) + PREALLOCATE_COUNT * 2);
+        constexpr deque() : map(nullptr), map_cap(0), map_head(0), blocks(0), first(0), s(0), spare(nullptr), spare_count(0) {}
 
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
+        deque(size_type count, const T& value) : deque() { assign(count, value); }
 
-            for (size_t i = 0; i < ((count + 63) / 64); i++, count -= 64)
-                buf.push_back(new deque_node*(detail::min(64ul, count)));
+        explicit deque(size_type count) : deque() { resize(count); }
 
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
+        template <typename It, typename = detail::require_input_ierator<It>>
+        deque(It f, It l) : deque()
+        {
+            assign(f, l);
         }
 
-        template <class It>
-        deque(It f, It l) { assign(f, l); }
-
         deque(const deque& other) : deque(other.begin(), other.end()) {}
 
-        deque(deque&& other) : buf(move(other.buf))
-        {
-            first_offset = other.first_offset;
-            s = other.s;
-            other.first_offset = other.s = 0;
-        }
+        deque(deque&& other) : deque() { swap(other); }
 
         deque(initializer_list<T> init) : deque(init.begin(), init.end()) {}
 
         ~deque()
         {
-            for (size_t i = 0; i < s; i++)
-                at(i).~T();
-
-            for (auto i : buf)
-                delete i;
-            buf.clear();
+            clear();
+            free_spare();
+            detail::deallocate(map);
         }
 
-        deque& operator=(const deque& other) { ~deque(); }
-
-        void assign(size_type count, const T& value)
+        deque& operator=(const deque& other)
         {
-            buf.clear();
-            s = count;
-            first_offset = 64 * PREALLOCATE_COUNT;
-
-            buf.reserve(((s + 63) / 64) + PREALLOCATE_COUNT * 2);
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
 
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
+        deque& operator=(deque&& other)
+        {
+            deque tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
 
-            for (size_t i = 0; i < ((s + 63) / 64); i++, count -= 64)
-                buf.push_back(new deque_node*(detail::min(64ul, count), value));
+        deque& operator=(initializer_list<T> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+            return *this;
+        }
 
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
+        void assign(size_type count, const T& value)
+        {
+            clear();
+            for (size_t i = 0; i < count; i++)
+                emplace_back(value);
         }
 
-        template <typename It>
+        template <typename It, typename = detail::require_input_ierator<It>>
         void assign(It f, It l)
         {
-            buf.clear();
-            first_offset = 64 * PREALLOCATE_COUNT;
-
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-
-            while (f != l)
-            {
-                auto val = new deque_node();
-                for (size_t i = 0; i < 64 && f != l; i++, f++)
-                {
-                    s++;
-                    val->init(i);
-                }
-                buf.push_back(val);
-            }
-
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
-            buf.push_back(new deque_node());
+            clear();
+            for (; f != l; ++f)
+                emplace_back(*f);
         }
 
-        void assign(std::initializer_list<T> ilist) { assign(ilist.begin(), ilist.end()); }
+        void assign(initializer_list<T> ilist) { assign(ilist.begin(), ilist.end()); }
 
         T& at(size_t pos)
         {
             if (pos >= s)
                 detail::errors::__stdexcept_out_of_range();
-            size_t i = pos + first_offset;
-            return buf[i / 64]->at(i % 64);
+            return *slot(pos);
         }
 
         const T& at(size_t pos) const
         {
             if (pos >= s)
                 detail::errors::__stdexcept_out_of_range();
-            size_t i = pos + first_offset;
-            return buf[i / 64]->at(i % 64);
+            return *slot(pos);
         }
 
-        T& operator[](size_t pos)
-        {
-            size_t i = pos + first_offset;
-            return buf[i / 64]->at(i % 64);
-        }
-
-        const T& operator[](size_t pos) const
-        {
-            size_t i = pos + first_offset;
-            return buf[i / 64]->at(i % 64);
-        }
+        T& operator[](size_t pos) { return *slot(pos); }
+        const T& operator[](size_t pos) const { return *slot(pos); }
 
-        reference front() { return *this[0]; }
-        const_reference front() const { return *this[0]; }
+        reference front() { return *slot(0); }
+        const_reference front() const { return *slot(0); }
 
-        reference back() { return *this[s - 1]; }
-        const_reference back() const { return *this[s - 1]; }
+        reference back() { return *slot(s - 1); }
+        const_reference back() const { return *slot(s - 1); }
 
         iterator begin() { return iterator(this, 0); }
         iterator end() { return iterator(this, s); }
@@ -284,9 +298,105 @@ namespace std
         size_type size() const noexcept { return s; }
         size_type max_size() const noexcept { return -1ul; }
 
-        void shrink_to_fit() { buf.shrink_to_fit(); }
+        // releases the spare blocks; blocks holding elements and the map stay where they are
+        void shrink_to_fit() { free_spare(); }
+
+        void clear() noexcept
+        {
+            if constexpr (!is_trivially_destructible_v<T>)
+                for (size_t i = 0; i < s; i++)
+                    destroy_at(slot(i));
+            s = 0;
+            trim();
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            size_t k = first + s;
+            if ((k >> BLOCK_SHIFT) == blocks)
+            {
+                reserve_map();
+                map[(map_head + blocks) & (map_cap - 1)] = take_block();
+                blocks++;
+            }
+
+            T* p = construct_at(block(k >> BLOCK_SHIFT) + (k & (BLOCK_SIZE - 1)), std::forward<Args>(args)...);
+            s++;
+            return *p;
+        }
 
-        void clear() noexcept { ~deque(); }
+        template <typename... Args>
+        reference emplace_front(Args&&... args)
+        {
+            if (first == 0)
+            {
+                reserve_map();
+                map_head = (map_head - 1) & (map_cap - 1);
+                map[map_head] = take_block();
+                blocks++;
+                first = BLOCK_SIZE;
+            }
+
+            T* p = construct_at(map[map_head] + first - 1, std::forward<Args>(args)...);
+            first--;
+            s++;
+            return *p;
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+        void push_front(const T& value) { emplace_front(value); }
+        void push_front(T&& value) { emplace_front(std::move(value)); }
+
+        void pop_back()
+        {
+            destroy_at(slot(s - 1));
+            s--;
+            trim();
+        }
+
+        void pop_front()
+        {
+            destroy_at(slot(0));
+            s--;
+            if (++first == BLOCK_SIZE && s)
+            {
+                recycle_block(map[map_head]);
+                map_head = (map_head + 1) & (map_cap - 1);
+                blocks--;
+                first = 0;
+            }
+            trim();
+        }
+
+        void resize(size_type count)
+        {
+            while (s > count)
+                pop_back();
+            while (s < count)
+                emplace_back();
+        }
+
+        void resize(size_type count, const value_type& value)
+        {
+            while (s > count)
+                pop_back();
+            while (s < count)
+                emplace_back(value);
+        }
+
+        void swap(deque& other) noexcept
+        {
+            std::swap(map, other.map);
+            std::swap(map_cap, other.map_cap);
+            std::swap(map_head, other.map_head);
+            std::swap(blocks, other.blocks);
+            std::swap(first, other.first);
+            std::swap(s, other.s);
+            std::swap(spare, other.spare);
+            std::swap(spare_count, other.spare_count);
+        }
     };
 } // namespace std
 #endif
@@ -0,0 +1,133 @@
+#ifndef __NOSTDLIB_FLAT_TREE_H__
+#define __NOSTDLIB_FLAT_TREE_H__
+#include "sort.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace std
+{
+    // tells the flat containers that their input is already sorted and free of duplicates, so it is taken as is
+    struct sorted_unique_t
+    {
+        explicit sorted_unique_t() = default;
+    };
+
+    inline constexpr sorted_unique_t sorted_unique{};
+
+    namespace detail
+    {
+        // sorts v and keeps only the first element of each run of equivalent ones
+        template <typename T, typename C>
+        void flat_sort_unique(vector<T>& v, C comp)
+        {
+            if (v.empty())
+                return;
+
+            T* first = v.data();
+            T* last = first + v.size();
+            pdqsort(first, last, comp);
+
+            T* out = first;
+            for (T* i = first + 1; i < last; i++)
+                if (comp(*out, *i) && ++out != i)
+                    *out = std::move(*i);
+            v.erase(v.cbegin() + (out + 1 - first), v.cend());
+        }
+
+        // Plain binary search over the sorted keys. The loop runs log2(n) times whatever the comparisons return, and
+        // the select compiles to a conditional move, so there are no mispredicted branches; the cost is paid in
+        // cache misses instead, which the eytzinger layout below avoids
+        template <typename Key, typename Compare>
+        struct flat_binary_search
+        {
+            template <bool Upper, typename K>
+            static size_t bound(const vector<Key>& keys, const K& k, const Compare& comp)
+            {
+                size_t n = keys.size();
+                if (!n)
+                    return 0;
+
+                const Key* base = keys.data();
+                while (n > 1)
+                {
+                    size_t half = n / 2;
+                    bool right = Upper ? !comp(k, base[half]) : comp(base[half], k);
+                    base = right ? base + half : base;
+                    n -= half;
+                }
+
+                return base - keys.data() + (Upper ? !comp(k, *base) : comp(*base, k));
+            }
+
+            void rebuild(const vector<Key>&) {}
+        };
+
+        // A copy of the keys in eytzinger (breadth first) order: node k of the implicit search tree has its children
+        // at 2k and 2k + 1, so the nodes a lookup visits next are adjacent and can be prefetched a few levels ahead,
+        // where a binary search over the sorted array misses the cache on nearly every step.
+        // Costs a second copy of the keys plus their ranks, and an O(n) rebuild after every change
+        template <typename Key, typename Compare>
+        class eytzinger_search
+        {
+            // node k (from 1) is at keys[k - 1], ranks[k - 1] is its position in the sorted array
+            vector<Key> keys;
+            vector<size_t> ranks;
+
+            // how many levels down a cache line's worth of descendants starts: they are the 2^d nodes from 2^d * k
+            static constexpr size_t prefetch_nodes()
+            {
+                size_t p = 1;
+                while (p * 2 * sizeof(Key) <= 64)
+                    p *= 2;
+                return p;
+            }
+
+            size_t number(size_t i, size_t k)
+            {
+                if (k <= ranks.size())
+                {
+                    i = number(i, 2 * k);
+                    ranks[k - 1] = i++;
+                    i = number(i, 2 * k + 1);
+                }
+                return i;
+            }
+
+        public:
+            template <bool Upper, typename K>
+            size_t bound(const vector<Key>& sorted, const K& key, const Compare& comp) const
+            {
+                size_t n = keys.size();
+                size_t k = 1;
+                while (k <= n)
+                {
+                    // may point past the end, which prefetch ignores
+                    __builtin_prefetch((const void*)((uintptr_t)keys.data() + (prefetch_nodes() * k - 1) * sizeof(Key)));
+                    const Key& node = keys[k - 1];
+                    k = 2 * k + (Upper ? !comp(key, node) : comp(node, key));
+                }
+
+                // k walked off the tree; the answer is the last node where the search went left
+                k >>= __builtin_ffsll(~k);
+                return k ? ranks[k - 1] : sorted.size();
+            }
+
+            void rebuild(const vector<Key>& sorted)
+            {
+                ranks.clear();
+                ranks.resize(sorted.size());
+                number(0, 1);
+
+                keys.clear();
+                keys.reserve(sorted.size());
+                for (size_t r : ranks)
+                    keys.push_back(sorted[r]);
+            }
+        };
+    } // namespace detail
+} // namespace std
+
+#endif
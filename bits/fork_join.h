@@ -0,0 +1,61 @@
+#ifndef __NOSTDLIB_FORK_JOIN_H__
+#define __NOSTDLIB_FORK_JOIN_H__
+#include "user_implement.h"
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace std::detail
+{
+    // the most threads one parallel call runs on, the caller included
+    inline constexpr size_t max_fork_threads = 64;
+
+    // Runs job(ctx) on the calling thread and on up to helpers threads of a pool at once, and returns once every run
+    // has returned. The pool's threads are started with thread_spawn the first time they are needed, live for the
+    // rest of the program, and park on an atomic wait between calls, so a call costs a wakeup per thread rather than
+    // a spawn and a join. A call made while the pool is busy, from another thread or from inside a job, runs
+    // job(ctx) on the calling thread alone. job must not throw: the pool threads use the caller's state until the
+    // last of them returns. src/fork_join.cpp
+    void fork_join_run(void (*job)(void*) noexcept, void* ctx, size_t helpers) noexcept;
+
+    // Runs f(begin, end) over consecutive chunks covering [0, n), splitting them between the calling thread and
+    // the threads of fork_join_run's pool, and returns once every chunk is done. Chunks are claimed from a shared
+    // counter, so a thread that gets easy chunks takes more of them. Each chunk has at least min_chunk indices, and
+    // there are about 8 per thread when n is large enough, which is what balances the load. f is called from
+    // several threads at once, and an exception leaving it calls terminate, as the parallel policies require
+    template <typename F>
+    void fork_join(size_t n, size_t min_chunk, F&& f)
+    {
+        size_t threads = cpu_count();
+        if (threads > max_fork_threads)
+            threads = max_fork_threads;
+        if (threads > n / min_chunk)
+            threads = n / min_chunk;
+        if (threads <= 1)
+        {
+            if (n)
+                [&]() noexcept { f(size_t(0), n); }();
+            return;
+        }
+
+        struct shared
+        {
+            remove_reference_t<F>* f;
+            size_t n;
+            size_t chunk;
+            atomic<size_t> next;
+        };
+
+        size_t chunk = n / (threads * 8);
+        shared s{&f, n, chunk < min_chunk ? min_chunk : chunk, 0};
+        auto work = [](void* p) noexcept {
+            shared& s = *(shared*)p;
+            for (size_t begin; (begin = s.next.fetch_add(s.chunk, memory_order_relaxed)) < s.n;)
+                (*s.f)(begin, s.n - begin < s.chunk ? s.n : begin + s.chunk);
+        };
+
+        fork_join_run(work, &s, threads - 1);
+    }
+} // namespace std::detail
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef __NOSTDLIB_BITS_HASH_H__
+#define __NOSTDLIB_BITS_HASH_H__
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace std
+{
+    namespace detail
+    {
+        // a 64-bit hash of n bytes, for hash specializations of byte strings
+        size_t hash_bytes(const void* p, size_t n, size_t seed = 0);
+
+        // hash<T> for enums; for other types without a specialization hash<T> is disabled
+        template <typename T, bool = is_enum_v<T>>
+        struct hash_enum
+        {
+            hash_enum() = delete;
+            hash_enum(const hash_enum&) = delete;
+            hash_enum& operator=(const hash_enum&) = delete;
+        };
+
+        template <typename T>
+        struct hash_enum<T, true>
+        {
+            size_t operator()(T v) const noexcept { return (size_t)v; }
+        };
+    } // namespace detail
+
+    // Integers and pointers hash to themselves, as in other standard libraries; the hash containers mix the bits
+    // themselves, so this costs nothing there
+    template <typename T>
+    struct hash : detail::hash_enum<T>
+    {
+    };
+
+    template <typename T>
+    struct hash<T*>
+    {
+        size_t operator()(T* p) const noexcept { return (size_t)p; }
+    };
+
+#define __NOSTDLIB_HASH_IDENTITY(T)                                                                                    \
+    template <>                                                                                                        \
+    struct hash<T>                                                                                                     \
+    {                                                                                                                  \
+        size_t operator()(T v) const noexcept { return (size_t)v; }                                                    \
+    };
+
+    __NOSTDLIB_HASH_IDENTITY(bool)
+    __NOSTDLIB_HASH_IDENTITY(char)
+    __NOSTDLIB_HASH_IDENTITY(signed char)
+    __NOSTDLIB_HASH_IDENTITY(unsigned char)
+    __NOSTDLIB_HASH_IDENTITY(wchar_t)
+#ifdef __cpp_char8_t
+    __NOSTDLIB_HASH_IDENTITY(char8_t)
+#endif
+    __NOSTDLIB_HASH_IDENTITY(char16_t)
+    __NOSTDLIB_HASH_IDENTITY(char32_t)
+    __NOSTDLIB_HASH_IDENTITY(short)
+    __NOSTDLIB_HASH_IDENTITY(unsigned short)
+    __NOSTDLIB_HASH_IDENTITY(int)
+    __NOSTDLIB_HASH_IDENTITY(unsigned int)
+    __NOSTDLIB_HASH_IDENTITY(long)
+    __NOSTDLIB_HASH_IDENTITY(unsigned long)
+    __NOSTDLIB_HASH_IDENTITY(long long)
+    __NOSTDLIB_HASH_IDENTITY(unsigned long long)
+
+#undef __NOSTDLIB_HASH_IDENTITY
+
+    template <>
+    struct hash<decltype(nullptr)>
+    {
+        size_t operator()(decltype(nullptr)) const noexcept { return 0; }
+    };
+
+    // 0.0 and -0.0 compare equal, so they must hash equal
+    template <>
+    struct hash<float>
+    {
+        size_t operator()(float v) const noexcept { return v == 0 ? 0 : detail::hash_bytes(&v, sizeof(v)); }
+    };
+
+    template <>
+    struct hash<double>
+    {
+        size_t operator()(double v) const noexcept { return v == 0 ? 0 : detail::hash_bytes(&v, sizeof(v)); }
+    };
+} // namespace std
+
+#endif
@@ -2,192 +2,194 @@
 #define __NOSTDLIB_BITS_HEAP_H__
 
 #include "iterator_simple_types.h"
-#include <utility>
+#include <cstddef>
 #include <functional>
+#include <utility>
 
 namespace std
 {
     namespace detail
     {
-        template <typename It, typename D, typename C>
-        D is_heap_until(It first, D n, C& comp)
+        // Heaps with Arity children per node: node i has children Arity * i + 1 ... Arity * i + Arity. The standard
+        // heap functions are the binary case; priority_queue defaults to 4 children, which halves the depth of the
+        // tree and has each pop compare siblings that sit next to each other in memory rather than one cache miss per
+        // level. set(i, v) stores v at index i, so that addressable heaps can track where their elements move
+
+        template <size_t Arity, typename It, typename D, typename C>
+        D heap_until(It first, D n, C& comp)
         {
-            D parent = 0;
-            for (D child = 1; child < n; ++child)
-            {
-                if (comp(first + parent, first + child))
-                    return child;
-                if ((child & 1) == 0)
-                    ++parent;
-            }
+            for (D i = 1; i < n; i++)
+                if (comp(first[(i - 1) / Arity], first[i]))
+                    return i;
             return n;
         }
 
-        template <typename It, typename D>
-        bool is_heap(It first, D n)
+        // fills the hole at i with v, moving it up past smaller parents
+        template <size_t Arity, typename It, typename D, typename T, typename C, typename S>
+        void heap_sift_up(It first, D i, T&& v, C& comp, S set)
         {
-            return is_heap_until(first, n, [](It a, It b) { return *a < *b; }) == n;
+            while (i > 0)
+            {
+                D parent = (i - 1) / Arity;
+                if (!comp(first[parent], v))
+                    break;
+                set(i, std::move(first[parent]));
+                i = parent;
+            }
+            set(i, std::move(v));
         }
 
-        template <typename It, typename C, typename D>
-        bool is_heap(It first, C comp, D n)
+        // fills the hole at i in a heap of len elements with v, moving it down past larger children
+        template <size_t Arity, typename It, typename D, typename T, typename C, typename S>
+        void heap_sift_down(It first, D i, D len, T&& v, C& comp, S set)
         {
-            return is_heap_until(first, n, [comp](It a, It b) { return comp(*a, *b); }) == n;
+            while (true)
+            {
+                D child = Arity * i + 1;
+                if (child >= len)
+                    break;
+
+                D last = len - child > (D)Arity ? child + Arity : len;
+                D best = child;
+                for (D c = child + 1; c < last; c++)
+                    best = comp(first[best], first[c]) ? c : best;
+
+                if (!comp(v, first[best]))
+                    break;
+                set(i, std::move(first[best]));
+                i = best;
+            }
+            set(i, std::move(v));
         }
 
         template <typename It>
-        bool is_heap(It first, It last)
+        auto heap_setter(It first)
         {
-            return is_heap(first, distance(first, last));
+            return [first](auto i, auto&& v) { first[i] = std::move(v); };
         }
 
-        template <typename It, typename C>
-        bool is_heap(It first, It last, C comp)
+        template <size_t Arity, typename It, typename C>
+        void push_heap(It first, It last, C& comp)
         {
-            return is_heap(first, std::move(comp), distance(first, last));
-        }
-
-        template <typename It, typename D, typename T, typename C>
-        void push_heap(It first, D i, D top, T v, C& comp)
-        {
-            D parent = (i - 1) / 2;
-            while (i > top && comp(first + parent, v))
-            {
-                *(first + i) = std::move(*(first + parent));
-                i = parent;
-                parent = (i - 1) / 2;
-            }
-            *(first + i) = std::move(v);
-        }
-        template <typename It, typename D, typename T, typename C>
-        void adjust_heap(It first, D i, D len, T val, C comp)
-        {
-            const D top = i;
-            D second = i;
-
-            while (second < (len - 1) / 2)
-            {
-                second = 2 * (second + 1);
-                if (comp(first + second, first + (second - 1)))
-                    second--;
-                *(first + i) = std::move(*(first + second));
-                i = second;
-            }
-
-            if ((len & 1) == 0 && second == (len - 2) / 2)
-            {
-                second = 2 * (second + 1);
-                *(first + i) = std::move(*(first + (second - 1)));
-                i = second - 1;
-            }
+            using value_t = typename iterator_traits<It>::value_type;
+            using diff_t = typename iterator_traits<It>::difference_type;
 
-            push_heap(first, i, top, std::move(val), [comp](It a, It b) { return comp(*a < *b); });
+            if (last - first < 2)
+                return;
+            value_t v = std::move(last[-1]);
+            heap_sift_up<Arity>(first, diff_t(last - first - 1), std::move(v), comp, heap_setter(first));
         }
 
-        template <typename It, typename C>
-        void pop_heap(It first, It last, It ret, C& comp)
+        // moves the top to last[-1] and restores the heap over [first, last - 1)
+        template <size_t Arity, typename It, typename C>
+        void pop_heap(It first, It last, C& comp)
         {
             using value_t = typename iterator_traits<It>::value_type;
             using diff_t = typename iterator_traits<It>::difference_type;
 
-            value_t value = std::move(*ret);
-            *ret = std::move(*first);
-            detail::adjust_heap(first, (0), diff_t(last - first), std::move(value), comp);
+            if (last - first < 2)
+                return;
+            --last;
+            value_t v = std::move(*last);
+            *last = std::move(*first);
+            heap_sift_down<Arity>(first, diff_t(0), diff_t(last - first), std::move(v), comp, heap_setter(first));
         }
 
-        template <typename It, typename C>
+        template <size_t Arity, typename It, typename C>
         void make_heap(It first, It last, C& comp)
         {
             using value_t = typename iterator_traits<It>::value_type;
             using diff_t = typename iterator_traits<It>::difference_type;
 
-            if (last - first < 2)
+            const diff_t len = last - first;
+            if (len < 2)
                 return;
 
-            const diff_t len = last - first;
-            diff_t parent = (len - 2) / 2;
-            while (true)
+            for (diff_t parent = (len - 2) / (diff_t)Arity + 1; parent-- > 0;)
             {
-                value_t value = std::move(*(first + parent));
-                adjust_heap(first, parent, len, std::move(value), comp);
-                if (parent == 0)
-                    return;
-                parent--;
+                value_t v = std::move(first[parent]);
+                heap_sift_down<Arity>(first, parent, len, std::move(v), comp, heap_setter(first));
             }
         }
+
+        template <size_t Arity, typename It, typename C>
+        void sort_heap(It first, It last, C& comp)
+        {
+            for (; last - first > 1; --last)
+                pop_heap<Arity>(first, last, comp);
+        }
     } // namespace detail
+
+    template <typename It, typename C>
+    void push_heap(It first, It last, C comp)
+    {
+        detail::push_heap<2>(first, last, comp);
+    }
+
     template <typename It>
     void push_heap(It first, It last)
     {
-        using value_t = typename iterator_traits<It>::value_type;
-        using diff_t = typename iterator_traits<It>::difference_type;
-
-        value_t v = std::move(*(last - 1));
-        detail::push_heap(first, diff_t((last - first) - 1), diff_t(0), std::move(v), [](It a, It b) { return *a < *b; });
+        push_heap(first, last, less<>());
     }
 
     template <typename It, typename C>
-    void push_heap(It first, It last, C comp)
+    void pop_heap(It first, It last, C comp)
     {
-        using value_t = typename iterator_traits<It>::value_type;
-        using diff_t = typename iterator_traits<It>::difference_type;
-
-        value_t value = std::move(*(last - 1));
-        detail::push_heap(first, diff_t((last - first) - 1), diff_t(0), std::move(value),
-                          [comp](It a, It b) { return comp(*a < *b); });
+        detail::pop_heap<2>(first, last, comp);
     }
 
     template <typename It>
     void pop_heap(It first, It last)
     {
-        if (last - first > 1)
-        {
-            --last;
-            detail::pop_heap(first, last, last, [](It a, It b) { *a < *b; });
-        }
+        pop_heap(first, last, less<>());
     }
+
     template <typename It, typename C>
-    void pop_heap(It first, It last, C comp)
+    void make_heap(It first, It last, C comp)
     {
-        if (last - first > 1)
-        {
-            --last;
-            detail::pop_heap(first, last, last, [comp](It a, It b) { comp(*a, *b); });
-        }
+        detail::make_heap<2>(first, last, comp);
     }
 
     template <typename It>
     void make_heap(It first, It last)
     {
-        detail::make_heap(first, last, [](It a, It b) { *a < *b; });
+        make_heap(first, last, less<>());
     }
 
-    template <typename It, typename C = less<typename iterator_traits<It>::value_type>>
-    void make_heap(It first, It last, C comp)
+    template <typename It, typename C>
+    void sort_heap(It first, It last, C comp)
     {
-        using value_t = typename iterator_traits<It>::value_type;
-            using diff_t = typename iterator_traits<It>::difference_type;
+        detail::sort_heap<2>(first, last, comp);
+    }
 
-            if (last - first < 2)
-                return;
+    template <typename It>
+    void sort_heap(It first, It last)
+    {
+        sort_heap(first, last, less<>());
+    }
 
-            const diff_t len = last - first;
-            diff_t parent = (len - 2) / 2;
-            while (true)
-            {
-                value_t value = std::move(*(first + parent));
-                adjust_heap(first, parent, len, std::move(value), [comp](It a, It b) { comp(*a, *b); });
-                if (parent == 0)
-                    return;
-                parent--;
-            }
+    template <typename It, typename C>
+    It is_heap_until(It first, It last, C comp)
+    {
+        return first + detail::heap_until<2>(first, last - first, comp);
     }
 
+    template <typename It>
+    It is_heap_until(It first, It last)
+    {
+        return is_heap_until(first, last, less<>());
+    }
 
-    template <typename It, typename C = less<typename iterator_traits<It>::value_type>>
-    void sort_heap(It first, It last, C comp)
+    template <typename It, typename C>
+    bool is_heap(It first, It last, C comp)
+    {
+        return is_heap_until(first, last, comp) == last;
+    }
+
+    template <typename It>
+    bool is_heap(It first, It last)
     {
-        sort_heap(first, last, last, [comp](It a, It b) { return comp(*a, *b); });
+        return is_heap_until(first, last) == last;
     }
 } // namespace std
 
@@ -0,0 +1,76 @@
+#ifndef __NOSTDLIB_INTRUSIVE_H__
+#define __NOSTDLIB_INTRUSIVE_H__
+#include "rbtree.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace std
+{
+    // Hooks are embedded in the objects an intrusive container links, and name it with a member pointer:
+    //     struct task { list_hook run_queue; ... };
+    //     intrusive_list<task, &task::run_queue> runnable;
+    // An object can sit in as many containers at once as it has hooks. Copying an object does not copy its links,
+    // and a hook must be unlinked (erased from its container) before the object goes away
+
+    struct slist_hook
+    {
+        slist_hook* next = nullptr;
+
+        slist_hook() = default;
+        slist_hook(const slist_hook&) {}
+        slist_hook& operator=(const slist_hook&) { return *this; }
+    };
+
+    // unlinked hooks have null pointers; linked ones never do, since the lists are circular
+    struct list_hook
+    {
+        list_hook* prev = nullptr;
+        list_hook* next = nullptr;
+
+        list_hook() = default;
+        list_hook(const list_hook&) {}
+        list_hook& operator=(const list_hook&) { return *this; }
+
+        bool is_linked() const { return next; }
+    };
+
+    struct rbtree_hook;
+
+    template <typename T, rbtree_hook T::*Hook, typename Compare, bool Multi>
+    class intrusive_rbtree;
+
+    struct rbtree_hook : detail::rbtree_node_base
+    {
+        rbtree_hook() { unlink(); }
+        rbtree_hook(const rbtree_hook&) { unlink(); }
+        rbtree_hook& operator=(const rbtree_hook&) { return *this; }
+
+        // a linked node always has a parent, if only the header
+        bool is_linked() const { return parent_color; }
+
+    private:
+        template <typename T, rbtree_hook T::*Hook, typename Compare, bool Multi>
+        friend class intrusive_rbtree;
+
+        void unlink()
+        {
+            parent_color = 0;
+            left = right = nullptr;
+        }
+    };
+
+    namespace detail
+    {
+        // gets from a hook back to the object around it
+        template <typename T, typename H, H T::*Member>
+        struct member_hook
+        {
+            static size_t offset() { return (uintptr_t)&(((T*)alignof(T))->*Member) - alignof(T); }
+
+            static H* hook_of(const T& v) { return (H*)&(v.*Member); }
+            static T* value_of(const H* h) { return (T*)((char*)h - offset()); }
+        };
+    } // namespace detail
+} // namespace std
+
+#endif
@@ -175,6 +175,30 @@ namespace std
         {
             return iterator_wrapper<It, C>(i.base() + n);
         }
+
+        // the pointer inside a container's iterator, so that algorithms over vectors and arrays run on plain pointers,
+        // which the compiler can vectorize and which can be handed to memmove
+        template <typename It>
+        constexpr It unwrap_iter(It i) noexcept
+        {
+            return i;
+        }
+
+        template <typename I, typename C>
+        constexpr I unwrap_iter(iterator_wrapper<I, C> i) noexcept
+        {
+            return i.base();
+        }
+
+        // converts the result of an algorithm on unwrap_iter(It) back to It
+        template <typename It, typename U>
+        constexpr It rewrap_iter(U u) noexcept
+        {
+            if constexpr (is_same_v<It, U>)
+                return u;
+            else
+                return It(u);
+        }
     } // namespace detail
 } // namespace std
 
@@ -11,7 +11,51 @@ namespace std
 
         first_type first;
         second_type second;
+
+        constexpr pair() : first(), second() {}
+        constexpr pair(const T1& x, const T2& y) : first(x), second(y) {}
+
+        template <typename U1, typename U2>
+        constexpr pair(U1&& x, U2&& y) : first(static_cast<U1&&>(x)), second(static_cast<U2&&>(y))
+        {
+        }
+
+        template <typename U1, typename U2>
+        constexpr pair(const pair<U1, U2>& p) : first(p.first), second(p.second)
+        {
+        }
+
+        template <typename U1, typename U2>
+        constexpr pair(pair<U1, U2>&& p) : first(static_cast<U1&&>(p.first)), second(static_cast<U2&&>(p.second))
+        {
+        }
+
+        pair(const pair&) = default;
+        pair(pair&&) = default;
+
+        constexpr pair& operator=(const pair& p)
+        {
+            first = p.first;
+            second = p.second;
+            return *this;
+        }
+
+        constexpr pair& operator=(pair&& p)
+        {
+            first = static_cast<T1&&>(p.first);
+            second = static_cast<T2&&>(p.second);
+            return *this;
+        }
     };
+
+    template <typename T1, typename T2>
+    pair(T1, T2) -> pair<T1, T2>;
+
+    template <typename T1, typename T2>
+    constexpr pair<T1, T2> make_pair(T1 x, T2 y)
+    {
+        return pair<T1, T2>(static_cast<T1&&>(x), static_cast<T2&&>(y));
+    }
 }
 
 #endif
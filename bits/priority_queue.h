@@ -1,15 +1,19 @@
 #ifndef __NOSTDLIB_BITS_PRIORITY_QUEUE_H__
 #define __NOSTDLIB_BITS_PRIORITY_QUEUE_H__
 #include "heap.h"
+#include <cstddef>
 #include <functional>
 #include <vector>
 
 namespace std
 {
-    template <typename T, typename S = vector<T>, typename C = less<typename S::value_type>>
+    // Arity is an extension: the number of children per heap node (see detail::heap_sift_down). 4 does fewer cache
+    // misses per pop than the standard binary layout; the order elements come out in is the same
+    template <typename T, typename S = vector<T>, typename C = less<typename S::value_type>, size_t Arity = 4>
     class priority_queue
     {
         static_assert(is_same_v<T, typename S::value_type>, "value_type must be the same as the underlying container");
+        static_assert(Arity >= 2, "a heap node needs at least two children");
 
     public:
         using value_type = T;
@@ -23,33 +27,35 @@ namespace std
         S c;
         C comp;
 
+        void heapify() { detail::make_heap<Arity>(c.begin(), c.end(), comp); }
+
     public:
         template <typename = enable_if_t<is_default_constructible_v<C> && is_default_constructible_v<S>>>
         priority_queue() : c(), comp()
         {
         }
-        explicit priority_queue(const C& c, const S& s) : c(s), comp(c) { make_heap(c.begin(), c.end(), comp); }
+        explicit priority_queue(const C& compare, const S& s) : c(s), comp(compare) { heapify(); }
 
-        explicit priority_queue(const C& c, S&& s = S()) : c(move(s)), comp(c) { make_heap(c.begin(), c.end(), comp); }
+        explicit priority_queue(const C& compare, S&& s = S()) : c(std::move(s)), comp(compare) { heapify(); }
 
         template <typename It>
-        priority_queue(It first, It last, const C& c = C()) : c(first, last), comp(c)
+        priority_queue(It first, It last, const C& compare = C()) : c(first, last), comp(compare)
         {
-            make_heap(c.begin(), c.end(), comp);
+            heapify();
         }
 
         template <typename It>
-        priority_queue(It first, It last, const C& c, const S& s) : c(s), comp(c)
+        priority_queue(It first, It last, const C& compare, const S& s) : c(s), comp(compare)
         {
             c.insert(c.end(), first, last);
-            make_heap(c.begin(), c.end(), comp);
+            heapify();
         }
 
         template <typename It>
-        priority_queue(It first, It last, const C& c, S&& s) : c(move(s)), comp(c)
+        priority_queue(It first, It last, const C& compare, S&& s) : c(std::move(s)), comp(compare)
         {
             c.insert(c.end(), first, last);
-            make_heap(c.begin(), c.end(), comp);
+            heapify();
         }
 
         [[nodiscard]] bool empty() const { return c.empty(); }
@@ -59,32 +65,192 @@ namespace std
         void push(const value_type& val)
         {
             c.push_back(val);
-            push_heap(c.begin(), c.end(), comp);
+            detail::push_heap<Arity>(c.begin(), c.end(), comp);
         }
 
         void push(value_type&& val)
         {
-            c.push_back(move(val));
-            push_heap(c.begin(), c.end(), comp);
+            c.push_back(std::move(val));
+            detail::push_heap<Arity>(c.begin(), c.end(), comp);
         }
 
         template <typename... Args>
         void emplace(Args&&... args)
         {
-            c.emplace_back(forward<Args>(args)...);
-            push_heap(c.begin(), c.end(), comp);
+            c.emplace_back(std::forward<Args>(args)...);
+            detail::push_heap<Arity>(c.begin(), c.end(), comp);
         }
 
         void pop()
         {
-            pop_heap(c.begin(), c.end(), comp);
+            detail::pop_heap<Arity>(c.begin(), c.end(), comp);
             c.pop_back();
         }
 
-        void swap(priority_queue& rhs) noexcept(is_nothrow_swappable_v<S>&& is_nothrow_swappable_v<C>)
+        void swap(priority_queue& rhs)
+        {
+            std::swap(c, rhs.c);
+            std::swap(comp, rhs.comp);
+        }
+    };
+
+    // A priority queue whose elements stay reachable after they are pushed: push returns a handle, valid until the
+    // element is popped or erased, through which the element can be reprioritized or removed in O(log n). This is
+    // what Dijkstra-style searches (decrease_key on a min-queue ordered by greater<>) and schedulers need.
+    // It is an indexed d-ary heap: the heap array holds each value with its handle, and a table indexed by handle
+    // tracks where in the heap the value currently is. Handles of removed elements are reused
+    template <typename T, typename C = less<T>, size_t Arity = 4>
+    class addressable_priority_queue
+    {
+        static_assert(Arity >= 2, "a heap node needs at least two children");
+
+    public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        using value_compare = C;
+        using handle = size_t;
+
+    private:
+        static constexpr size_t npos = (size_t)-1;
+
+        struct entry
+        {
+            T value;
+            handle h;
+        };
+
+        struct entry_compare
+        {
+            C& comp;
+            bool operator()(const entry& a, const entry& b) const { return comp(a.value, b.value); }
+        };
+
+        vector<entry> heap;
+        // heap index of each handle, npos for free handles
+        vector<size_t> index;
+        vector<handle> free_handles;
+        C comp;
+
+        auto setter()
+        {
+            return [this](size_t i, entry&& e) {
+                index[e.h] = i;
+                heap[i] = std::move(e);
+            };
+        }
+
+        void sift_up(size_t i, entry&& e)
+        {
+            entry_compare cmp{comp};
+            detail::heap_sift_up<Arity>(heap.data(), i, std::move(e), cmp, setter());
+        }
+
+        void sift_down(size_t i, entry&& e)
+        {
+            entry_compare cmp{comp};
+            detail::heap_sift_down<Arity>(heap.data(), i, heap.size(), std::move(e), cmp, setter());
+        }
+
+        // fills the hole at i with e, which may belong above or below it
+        void place(size_t i, entry&& e)
+        {
+            if (i > 0 && comp(heap[(i - 1) / Arity].value, e.value))
+                sift_up(i, std::move(e));
+            else
+                sift_down(i, std::move(e));
+        }
+
+        handle acquire()
+        {
+            if (!free_handles.empty())
+            {
+                handle h = free_handles.back();
+                free_handles.pop_back();
+                return h;
+            }
+            index.push_back(npos);
+            return index.size() - 1;
+        }
+
+    public:
+        addressable_priority_queue() = default;
+        explicit addressable_priority_queue(const C& compare) : comp(compare) {}
+
+        [[nodiscard]] bool empty() const { return heap.empty(); }
+        [[nodiscard]] size_type size() const { return heap.size(); }
+        [[nodiscard]] const_reference top() const { return heap.front().value; }
+        [[nodiscard]] handle top_handle() const { return heap.front().h; }
+
+        void reserve(size_type n)
+        {
+            heap.reserve(n);
+            index.reserve(n);
+        }
+
+        // whether h refers to an element still in the queue
+        bool contains(handle h) const { return h < index.size() && index[h] != npos; }
+        const_reference operator[](handle h) const { return heap[index[h]].value; }
+
+        handle push(const value_type& val) { return emplace(val); }
+        handle push(value_type&& val) { return emplace(std::move(val)); }
+
+        template <typename... Args>
+        handle emplace(Args&&... args)
+        {
+            handle h = acquire();
+            heap.push_back(entry{T(std::forward<Args>(args)...), h});
+            entry e = std::move(heap.back());
+            sift_up(heap.size() - 1, std::move(e));
+            return h;
+        }
+
+        void pop() { erase(top_handle()); }
+
+        void erase(handle h)
+        {
+            size_t i = index[h];
+            index[h] = npos;
+            free_handles.push_back(h);
+
+            entry last = std::move(heap.back());
+            heap.pop_back();
+            if (i < heap.size())
+                place(i, std::move(last));
+        }
+
+        // gives the element at h a value that compares no less than its current one, moving it towards the top; with
+        // a greater<> queue, this lowers its key
+        void decrease_key(handle h, const value_type& val) { decrease_key(h, value_type(val)); }
+        void decrease_key(handle h, value_type&& val)
+        {
+            size_t i = index[h];
+            sift_up(i, entry{std::move(val), h});
+        }
+
+        // gives the element at h any new value
+        void update(handle h, const value_type& val) { update(h, value_type(val)); }
+        void update(handle h, value_type&& val)
+        {
+            size_t i = index[h];
+            place(i, entry{std::move(val), h});
+        }
+
+        // invalidates every handle
+        void clear()
+        {
+            heap.clear();
+            index.clear();
+            free_handles.clear();
+        }
+
+        void swap(addressable_priority_queue& rhs)
         {
-            swap(c, rhs.c);
-            swap(comp, rhs.comp);
+            std::swap(heap, rhs.heap);
+            std::swap(index, rhs.index);
+            std::swap(free_handles, rhs.free_handles);
+            std::swap(comp, rhs.comp);
         }
     };
 } // namespace std
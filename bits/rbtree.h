@@ -1,54 +1,767 @@
 #ifndef __NOSTDLIB_RBTREE_H__
 #define __NOSTDLIB_RBTREE_H__
-#include <type_traits>
+#include "iterator_simple_types.h"
+#include "reverse_iterator.h"
+#include "uninitialized.h"
+#include "user_implement.h"
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
 
 namespace std::detail
 {
-    template<typename T>
-    class rbtree_node
+    // The untyped part of a red-black tree node. The color lives in the low bit of the parent pointer (set means
+    // black), so a node is three words plus the value.
+    // Every tree has a header node: header.parent is the root, header.left the leftmost and header.right the
+    // rightmost node, and the root's parent is the header. The header is the only red node whose grandparent is
+    // itself, which is how decrementing end() finds the last node.
+    struct rbtree_node_base
+    {
+        inline static constexpr uintptr_t BLACK = 1;
+
+        uintptr_t parent_color;
+        rbtree_node_base* left;
+        rbtree_node_base* right;
+
+        rbtree_node_base* parent() const { return (rbtree_node_base*)(parent_color & ~BLACK); }
+        void set_parent(rbtree_node_base* p) { parent_color = (uintptr_t)p | (parent_color & BLACK); }
+
+        bool is_red() const { return !(parent_color & BLACK); }
+        bool is_black() const { return parent_color & BLACK; }
+        void set_red() { parent_color &= ~BLACK; }
+        void set_black() { parent_color |= BLACK; }
+        void set_color_of(const rbtree_node_base* n) { parent_color = (parent_color & ~BLACK) | (n->parent_color & BLACK); }
+
+        static rbtree_node_base* minimum(rbtree_node_base* x)
+        {
+            while (x->left)
+                x = x->left;
+            return x;
+        }
+
+        static rbtree_node_base* maximum(rbtree_node_base* x)
+        {
+            while (x->right)
+                x = x->right;
+            return x;
+        }
+    };
+
+    // (re)initializes header as the header of an empty tree
+    inline void rbtree_reset(rbtree_node_base& header)
+    {
+        header.parent_color = 0;
+        header.left = header.right = &header;
+    }
+
+    // in-order successor and predecessor; the successor of the rightmost node is the header and the predecessor of
+    // the header is the rightmost node
+    rbtree_node_base* rbtree_increment(const rbtree_node_base* x);
+    rbtree_node_base* rbtree_decrement(const rbtree_node_base* x);
+
+    // links x as the left or right child of parent (which may be the header of an empty tree), keeps the header
+    // up to date and restores the red-black invariants
+    void rbtree_insert_rebalance(bool left, rbtree_node_base* x, rbtree_node_base* parent, rbtree_node_base& header);
+
+    // unlinks z from the tree, keeps the header up to date and restores the red-black invariants
+    void rbtree_erase_rebalance(rbtree_node_base* z, rbtree_node_base& header);
+
+    template <typename Value>
+    struct rbtree_node : rbtree_node_base
+    {
+        Value value;
+    };
+
+    template <typename Value, bool Const>
+    class rbtree_iterator
+    {
+        template <typename, typename, typename, typename, bool>
+        friend class rbtree;
+        template <typename, bool>
+        friend class rbtree_iterator;
+
+        using node = rbtree_node<Value>;
+        rbtree_node_base* current;
+
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = Value;
+        using difference_type = ptrdiff_t;
+        using reference = conditional_t<Const, const Value&, Value&>;
+        using pointer = conditional_t<Const, const Value*, Value*>;
+
+        constexpr rbtree_iterator() noexcept : current(nullptr) {}
+        explicit rbtree_iterator(const rbtree_node_base* n) noexcept : current((rbtree_node_base*)n) {}
+        template <bool C, typename = enable_if_t<Const && !C>>
+        rbtree_iterator(const rbtree_iterator<Value, C>& i) noexcept : current(i.current)
+        {
+        }
+
+        reference operator*() const noexcept { return ((node*)current)->value; }
+        pointer operator->() const noexcept { return &((node*)current)->value; }
+
+        rbtree_iterator& operator++() noexcept
+        {
+            current = rbtree_increment(current);
+            return *this;
+        }
+
+        rbtree_iterator operator++(int) noexcept
+        {
+            rbtree_iterator tmp = *this;
+            current = rbtree_increment(current);
+            return tmp;
+        }
+
+        rbtree_iterator& operator--() noexcept
+        {
+            current = rbtree_decrement(current);
+            return *this;
+        }
+
+        rbtree_iterator operator--(int) noexcept
+        {
+            rbtree_iterator tmp = *this;
+            current = rbtree_decrement(current);
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const rbtree_iterator<Value, C>& rhs) const noexcept
+        {
+            return current == rhs.current;
+        }
+
+        template <bool C>
+        bool operator!=(const rbtree_iterator<Value, C>& rhs) const noexcept
+        {
+            return current != rhs.current;
+        }
+    };
+
+    // owns a node that has been extracted from a tree, see map::extract
+    template <typename Value, typename Key, typename Mapped>
+    class rbtree_node_handle
     {
-        rbtree_node* parent;
-        rbtree_node* l;
-        rbtree_node* r;
-        T data;
+        template <typename, typename, typename, typename, bool>
+        friend class rbtree;
+
+        using node = rbtree_node<Value>;
+        node* n;
+
+        explicit rbtree_node_handle(node* n) : n(n) {}
+
     public:
-        template<typename = enable_if_t<is_default_constructible_v<T>>>
-        constexpr rbtree_node() : parent(nullptr), l(nullptr), r(nullptr), T() {}
-        constexpr rbtree_node(rbtree_node* parent) : parent(parent), l(nullptr), r(nullptr), T() {}
+        using key_type = Key;
+        using value_type = Value;
+        using mapped_type = Mapped;
+
+        constexpr rbtree_node_handle() : n(nullptr) {}
+        rbtree_node_handle(const rbtree_node_handle&) = delete;
+        rbtree_node_handle(rbtree_node_handle&& other) : n(other.n) { other.n = nullptr; }
 
-        rbtree_node& left(rbtree_node* n)
+        rbtree_node_handle& operator=(rbtree_node_handle&& other)
         {
-            l = n;
+            if (this != &other)
+            {
+                reset();
+                n = other.n;
+                other.n = nullptr;
+            }
             return *this;
         }
 
-        rbtree_node& right(rbtree_node* n)
+        ~rbtree_node_handle() { reset(); }
+
+        [[nodiscard]] bool empty() const noexcept { return !n; }
+        explicit operator bool() const noexcept { return n; }
+
+        // set nodes only
+        value_type& value() const { return n->value; }
+
+        // map nodes only; the key may be changed before the node is inserted again
+        key_type& key() const { return const_cast<key_type&>(n->value.first); }
+        mapped_type& mapped() const { return n->value.second; }
+
+        void reset()
         {
-            r = n;
-            return *this; 
+            if (n)
+            {
+                destroy_at(&n->value);
+                detail::deallocate(n);
+                n = nullptr;
+            }
         }
+    };
+
+    template <typename Iter, typename NodeHandle>
+    struct rbtree_insert_return
+    {
+        Iter position;
+        bool inserted;
+        NodeHandle node;
+    };
 
-        constexpr rbtree_node* left() { return l; }
-        constexpr rbtree_node* right() { return r; }
+    // the mapped type of map nodes; set nodes have none and use their value
+    template <typename Value>
+    struct rbtree_mapped
+    {
+        using type = Value;
     };
 
-    template <typename T, typename C = less<T>>
+    template <typename K, typename T>
+    struct rbtree_mapped<pair<const K, T>>
+    {
+        using type = T;
+    };
+
+    // The typed tree behind map, set, multimap and multiset. Value is what the nodes hold and KeyOfValue extracts
+    // the Key from it. Multi allows equal keys, which keep their insertion order.
+    // Erased nodes can be kept for reuse: after reserve_nodes(n) the tree holds on to up to n spare nodes, so
+    // insert/erase churn within that many elements does not go to the allocator
+    template <typename Key, typename Value, typename KeyOfValue, typename Compare, bool Multi>
     class rbtree
     {
-        rbtree_node<T>* root;
-        size_t s;
-        C cmp;
+        template <typename, typename, typename, typename, bool>
+        friend class rbtree;
+
     public:
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using key_compare = Compare;
+        // set elements are their own keys and stay const
+        using iterator = rbtree_iterator<Value, is_same_v<Key, Value>>;
+        using const_iterator = rbtree_iterator<Value, true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        struct insert_pos
+        {
+            rbtree_node_base* parent;
+            bool left;
+            // the node with an equal key that prevents a unique insert
+            rbtree_node_base* existing;
+        };
+
+    private:
+        using node = rbtree_node<Value>;
+        using base = rbtree_node_base;
+
+        base header;
+        size_t s;
+        Compare cmp;
+
+        // spare nodes, linked through their right pointer
+        base* pool;
+        size_t pool_size;
+        size_t pool_limit;
+
+        static const Key& key_of(const base* n) { return KeyOfValue()(((const node*)n)->value); }
+
+        base* root() const { return header.parent(); }
+        base* end_node() const { return (base*)&header; }
+
+        node* get_node()
+        {
+            if (!pool)
+                return detail::allocate<node>(1);
+
+            base* n = pool;
+            pool = n->right;
+            pool_size--;
+            return (node*)n;
+        }
+
+        void put_node(node* n)
+        {
+            if (pool_size < pool_limit)
+            {
+                n->right = pool;
+                pool = n;
+                pool_size++;
+            }
+            else
+                detail::deallocate(n);
+        }
+
+        template <typename... Args>
+        node* create_node(Args&&... args)
+        {
+            node* n = get_node();
+            construct_at(&n->value, std::forward<Args>(args)...);
+            return n;
+        }
+
+        void drop_node(node* n)
+        {
+            destroy_at(&n->value);
+            put_node(n);
+        }
+
+        // frees a subtree without rebalancing; recurses right and loops left, so the depth is the tree height
+        void drop_subtree(base* x)
+        {
+            while (x)
+            {
+                drop_subtree(x->right);
+                base* l = x->left;
+                drop_node((node*)x);
+                x = l;
+            }
+        }
+
+        // copies the subtree x, colors included, below parent
+        base* clone_subtree(const base* x, base* parent)
+        {
+            base* top = nullptr;
+            base** link = &top;
+            for (; x; x = x->left)
+            {
+                node* y = create_node(((const node*)x)->value);
+                y->parent_color = (uintptr_t)parent | (x->parent_color & base::BLACK);
+                y->left = y->right = nullptr;
+                *link = y;
+                if (x->right)
+                    y->right = clone_subtree(x->right, y);
+
+                link = &y->left;
+                parent = y;
+            }
+            return top;
+        }
 
+        void copy_from(const rbtree& other)
+        {
+            if (!other.root())
+                return;
+
+            base* r = clone_subtree(other.root(), &header);
+            header.set_parent(r);
+            header.left = base::minimum(r);
+            header.right = base::maximum(r);
+            s = other.s;
+        }
+
+        void steal(rbtree& other)
+        {
+            if (other.root())
+            {
+                header = other.header;
+                root()->set_parent(&header);
+                rbtree_reset(other.header);
+            }
+            s = other.s;
+            other.s = 0;
+        }
+
+        template <typename K>
+        base* lower_bound_node(const K& k) const
+        {
+            base* y = end_node();
+            for (base* x = root(); x;)
+            {
+                if (!cmp(key_of(x), k))
+                {
+                    y = x;
+                    x = x->left;
+                }
+                else
+                    x = x->right;
+            }
+            return y;
+        }
 
-        [[nodiscard]] constexpr size_t size() { return s; }
+        template <typename K>
+        base* upper_bound_node(const K& k) const
+        {
+            base* y = end_node();
+            for (base* x = root(); x;)
+            {
+                if (cmp(k, key_of(x)))
+                {
+                    y = x;
+                    x = x->left;
+                }
+                else
+                    x = x->right;
+            }
+            return y;
+        }
+
+        // a <= b for multi trees and a < b for unique ones, i.e. whether b may go right after a
+        bool may_follow(const Key& a, const Key& b) const
+        {
+            if constexpr (Multi)
+                return !cmp(b, a);
+            else
+                return cmp(a, b);
+        }
+
+    public:
+        explicit rbtree(const Compare& c = Compare()) : s(0), cmp(c), pool(nullptr), pool_size(0), pool_limit(0)
+        {
+            rbtree_reset(header);
+        }
+
+        rbtree(const rbtree& other) : rbtree(other.cmp) { copy_from(other); }
+        rbtree(rbtree&& other) : rbtree(other.cmp) { steal(other); }
 
         ~rbtree()
         {
-            
+            clear();
+            release_nodes();
+        }
+
+        rbtree& operator=(const rbtree& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                cmp = other.cmp;
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        rbtree& operator=(rbtree&& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                cmp = other.cmp;
+                steal(other);
+            }
+            return *this;
+        }
+
+        iterator begin() { return iterator(header.left); }
+        iterator end() { return iterator(&header); }
+        const_iterator begin() const { return const_iterator(header.left); }
+        const_iterator end() const { return const_iterator(&header); }
+
+        [[nodiscard]] bool empty() const noexcept { return s == 0; }
+        size_type size() const noexcept { return s; }
+        size_type max_size() const noexcept { return (size_type)-1 / sizeof(node); }
+        key_compare key_comp() const { return cmp; }
+
+        void clear()
+        {
+            drop_subtree(root());
+            rbtree_reset(header);
+            s = 0;
+        }
+
+        void swap(rbtree& other)
+        {
+            rbtree tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        // keeps up to n erased nodes for reuse, and allocates them up front
+        void reserve_nodes(size_t n)
+        {
+            pool_limit = n;
+            while (pool_size < n)
+                put_node(detail::allocate<node>(1));
+        }
+
+        // frees the spare nodes and stops keeping new ones
+        void release_nodes()
+        {
+            pool_limit = 0;
+            while (pool)
+            {
+                base* n = pool;
+                pool = n->right;
+                detail::deallocate((node*)n);
+            }
+            pool_size = 0;
+        }
+
+        // where a node with key k would go; for unique trees existing is set instead if k is already present
+        insert_pos find_insert_pos(const Key& k) const
+        {
+            base* parent = end_node();
+            bool left = true;
+            for (base* x = root(); x;)
+            {
+                parent = x;
+                // equal keys go to the right, after the ones already there
+                left = cmp(k, key_of(x));
+                x = left ? x->left : x->right;
+            }
+
+            if constexpr (!Multi)
+            {
+                // the only candidate for an equal key is the in-order predecessor of the new position
+                base* pred = left ? (parent == header.left ? nullptr : rbtree_decrement(parent)) : parent;
+                if (pred && !cmp(key_of(pred), k))
+                    return {nullptr, false, pred};
+            }
+            return {parent, left, nullptr};
+        }
+
+        // same, but checks the neighbours of hint first: if k belongs right before hint this costs O(1) comparisons
+        insert_pos find_insert_pos(const_iterator hint, const Key& k) const
+        {
+            base* h = hint.current;
+            if (h == end_node())
+            {
+                if (s && may_follow(key_of(header.right), k))
+                    return {header.right, false, nullptr};
+                return find_insert_pos(k);
+            }
+
+            if (may_follow(k, key_of(h)))
+            {
+                if (h == header.left)
+                    return {h, true, nullptr};
+
+                base* before = rbtree_decrement(h);
+                if (may_follow(key_of(before), k))
+                    return before->right ? insert_pos{h, true, nullptr} : insert_pos{before, false, nullptr};
+                return find_insert_pos(k);
+            }
+
+            if constexpr (!Multi)
+            {
+                if (!cmp(key_of(h), k))
+                    return {nullptr, false, h};
+
+                if (h == header.right)
+                    return {h, false, nullptr};
+
+                base* after = rbtree_increment(h);
+                if (cmp(k, key_of(after)))
+                    return h->right ? insert_pos{after, true, nullptr} : insert_pos{h, false, nullptr};
+            }
+            return find_insert_pos(k);
+        }
+
+        template <typename... Args>
+        iterator emplace_at(insert_pos pos, Args&&... args)
+        {
+            node* n = create_node(std::forward<Args>(args)...);
+            rbtree_insert_rebalance(pos.left, n, pos.parent, header);
+            s++;
+            return iterator(n);
+        }
+
+        template <typename V>
+        pair<iterator, bool> insert(V&& v)
+        {
+            insert_pos pos = find_insert_pos(KeyOfValue()(v));
+            if (pos.existing)
+                return {iterator(pos.existing), false};
+            return {emplace_at(pos, std::forward<V>(v)), true};
+        }
+
+        template <typename V>
+        iterator insert(const_iterator hint, V&& v)
+        {
+            insert_pos pos = find_insert_pos(hint, KeyOfValue()(v));
+            if (pos.existing)
+                return iterator(pos.existing);
+            return emplace_at(pos, std::forward<V>(v));
+        }
+
+        // the key is only known once the value is built, so the node is built first and dropped if it is a duplicate
+        template <typename... Args>
+        pair<iterator, bool> emplace(Args&&... args)
+        {
+            node* n = create_node(std::forward<Args>(args)...);
+            insert_pos pos = find_insert_pos(key_of(n));
+            if (pos.existing)
+            {
+                drop_node(n);
+                return {iterator(pos.existing), false};
+            }
+
+            rbtree_insert_rebalance(pos.left, n, pos.parent, header);
+            s++;
+            return {iterator(n), true};
+        }
+
+        template <typename... Args>
+        iterator emplace_hint(const_iterator hint, Args&&... args)
+        {
+            node* n = create_node(std::forward<Args>(args)...);
+            insert_pos pos = find_insert_pos(hint, key_of(n));
+            if (pos.existing)
+            {
+                drop_node(n);
+                return iterator(pos.existing);
+            }
+
+            rbtree_insert_rebalance(pos.left, n, pos.parent, header);
+            s++;
+            return iterator(n);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            base* n = pos.current;
+            base* next = rbtree_increment(n);
+            rbtree_erase_rebalance(n, header);
+            drop_node((node*)n);
+            s--;
+            return iterator(next);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            if (first == begin() && last == end())
+            {
+                clear();
+                return end();
+            }
+
+            while (first != last)
+                first = erase(first);
+            return iterator(last.current);
+        }
+
+        template <typename K>
+        size_type erase_key(const K& k)
+        {
+            auto [first, last] = equal_range(k);
+            size_type n = 0;
+            for (; first != last; n++)
+                first = erase(first);
+            return n;
+        }
+
+        using node_type = rbtree_node_handle<Value, Key, typename rbtree_mapped<Value>::type>;
+        using insert_return_type = rbtree_insert_return<iterator, node_type>;
+
+        node_type extract(const_iterator pos)
+        {
+            base* n = pos.current;
+            rbtree_erase_rebalance(n, header);
+            s--;
+            return node_type((node*)n);
+        }
+
+        insert_return_type insert(node_type&& nh)
+        {
+            if (!nh)
+                return {end(), false, node_type()};
+
+            insert_pos pos = find_insert_pos(key_of(nh.n));
+            if (pos.existing)
+                return {iterator(pos.existing), false, std::move(nh)};
+
+            rbtree_insert_rebalance(pos.left, nh.n, pos.parent, header);
+            s++;
+            iterator it(nh.n);
+            nh.n = nullptr;
+            return {it, true, node_type()};
+        }
+
+        iterator insert(const_iterator hint, node_type&& nh)
+        {
+            if (!nh)
+                return end();
+
+            insert_pos pos = find_insert_pos(hint, key_of(nh.n));
+            if (pos.existing)
+                return iterator(pos.existing);
+
+            rbtree_insert_rebalance(pos.left, nh.n, pos.parent, header);
+            s++;
+            iterator it(nh.n);
+            nh.n = nullptr;
+            return it;
+        }
+
+        // moves the nodes of other over without copying or reallocating them; for unique trees the nodes whose key
+        // is already present stay in other
+        template <typename C2, bool Multi2>
+        void merge(rbtree<Key, Value, KeyOfValue, C2, Multi2>& other)
+        {
+            for (base* n = other.header.left; n != other.end_node();)
+            {
+                base* next = rbtree_increment(n);
+                insert_pos pos = find_insert_pos(key_of(n));
+                if (!pos.existing)
+                {
+                    rbtree_erase_rebalance(n, other.header);
+                    other.s--;
+                    rbtree_insert_rebalance(pos.left, n, pos.parent, header);
+                    s++;
+                }
+                n = next;
+            }
+        }
+
+        template <typename K>
+        iterator find(const K& k)
+        {
+            base* n = lower_bound_node(k);
+            return iterator(n == end_node() || cmp(k, key_of(n)) ? end_node() : n);
+        }
+
+        template <typename K>
+        const_iterator find(const K& k) const
+        {
+            base* n = lower_bound_node(k);
+            return const_iterator(n == end_node() || cmp(k, key_of(n)) ? end_node() : n);
+        }
+
+        template <typename K>
+        iterator lower_bound(const K& k)
+        {
+            return iterator(lower_bound_node(k));
+        }
+
+        template <typename K>
+        const_iterator lower_bound(const K& k) const
+        {
+            return const_iterator(lower_bound_node(k));
+        }
+
+        template <typename K>
+        iterator upper_bound(const K& k)
+        {
+            return iterator(upper_bound_node(k));
+        }
+
+        template <typename K>
+        const_iterator upper_bound(const K& k) const
+        {
+            return const_iterator(upper_bound_node(k));
+        }
+
+        template <typename K>
+        pair<iterator, iterator> equal_range(const K& k)
+        {
+            return {lower_bound(k), upper_bound(k)};
+        }
+
+        template <typename K>
+        pair<const_iterator, const_iterator> equal_range(const K& k) const
+        {
+            return {lower_bound(k), upper_bound(k)};
+        }
+
+        template <typename K>
+        size_type count(const K& k) const
+        {
+            if constexpr (!Multi)
+                return find(k) != end();
+
+            size_type n = 0;
+            for (auto [first, last] = equal_range(k); first != last; ++first)
+                n++;
+            return n;
         }
     };
-}
+} // namespace std::detail
 
 #endif
@@ -37,19 +37,19 @@ namespace std
     public:
         constexpr reverse_iterator() noexcept(noexcept(I())) : iter() {}
         explicit constexpr reverse_iterator(iterator_type t) noexcept(noexcept(I(t))) : iter(t) {}
-        constexpr reverse_iterator(const reverse_iterator& i) noexcept(noexcept(I(i.current))) : iter(i.current) {}
+        constexpr reverse_iterator(const reverse_iterator& i) noexcept(noexcept(I(i.iter))) : iter(i.iter) {}
         reverse_iterator& operator=(const reverse_iterator&) = default;
         template <typename It>
-        constexpr reverse_iterator(const reverse_iterator<It>& i) noexcept(noexcept(I(i.iter))) : iter(i.iter)
+        constexpr reverse_iterator(const reverse_iterator<It>& i) noexcept(noexcept(I(i.base()))) : iter(i.base())
         {
         }
 
         [[nodiscard]] constexpr iterator_type base() const noexcept(noexcept(I(iter))) { return iter; }
 
         template <typename It>
-        constexpr reverse_iterator& operator=(const reverse_iterator<It>& i) noexcept(noexcept(iter = i.iter))
+        constexpr reverse_iterator& operator=(const reverse_iterator<It>& i) noexcept(noexcept(iter = i.base()))
         {
-            iter = i.iter;
+            iter = i.base();
             return *this;
         }
 
@@ -0,0 +1,675 @@
+#ifndef __NOSTDLIB_BITS_SORT_H__
+#define __NOSTDLIB_BITS_SORT_H__
+#include "heap.h"
+#include "iterator_simple_types.h"
+#include "uninitialized.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace std
+{
+    namespace detail
+    {
+        // Whether comparing two Ts with C is cheap and free of side effects, so that the sort can evaluate comparisons
+        // it does not strictly need and select results with conditional moves instead of branching on them
+        template <typename T, typename C>
+        inline constexpr bool is_branchless_sort_v =
+            (is_arithmetic_v<T> || is_pointer_v<T>) && (is_same_v<C, less<T>> || is_same_v<C, less<>> ||
+                                                        is_same_v<C, greater<T>> || is_same_v<C, greater<>>);
+
+        template <typename It>
+        using iter_value_t = typename iterator_traits<It>::value_type;
+
+        template <typename It>
+        using iter_diff_t = typename iterator_traits<It>::difference_type;
+
+        // Sorting networks for 2 to 16 elements, as pairs of indices to compare and exchange: the optimal networks up
+        // to 8, and Batcher's odd-even merge sort above that. Their comparisons do not depend on each other's
+        // results, so with a branchless compare-exchange a whole network runs without a branch to mispredict
+        inline constexpr uint8_t sort_networks[] = {
+            // 2 inputs, 1 comparator
+            0, 1,
+            // 3 inputs, 3 comparators
+            0, 1, 0, 2, 1, 2,
+            // 4 inputs, 5 comparators
+            0, 1, 2, 3, 0, 2, 1, 3, 1, 2,
+            // 5 inputs, 9 comparators
+            0, 1, 2, 3, 0, 2, 1, 3, 1, 2, 0, 4, 2, 4, 1, 2, 3, 4,
+            // 6 inputs, 12 comparators
+            0, 1, 2, 3, 4, 5, 0, 2, 1, 3, 1, 2, 0, 4, 1, 5, 2, 4, 3, 5, 1, 2, 3, 4,
+            // 7 inputs, 16 comparators
+            0, 1, 2, 3, 4, 5, 0, 2, 1, 3, 4, 6, 1, 2, 5, 6, 0, 4, 1, 5, 2, 6, 2, 4, 3, 5, 1, 2, 3, 4, 5, 6,
+            // 8 inputs, 19 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 0, 2, 1, 3, 4, 6, 5, 7, 1, 2, 5, 6, 0, 4, 3, 7, 1, 5, 2, 6, 2, 4, 3, 5, 1, 2, 3, 4, 5, 6,
+            // 9 inputs, 28 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 0, 2, 1, 3, 4, 6, 5, 7, 1, 2, 5, 6, 0, 4, 3, 7, 1, 5, 2, 6, 0, 8, 2, 4, 3, 5, 1, 2, 3, 4,
+            5, 6, 4, 8, 3, 5, 2, 4, 6, 8, 1, 2, 3, 4, 5, 6, 7, 8,
+            // 10 inputs, 32 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 2, 1, 3, 4, 6, 5, 7, 1, 2, 5, 6, 0, 4, 3, 7, 1, 5, 2, 6, 0, 8, 2, 4, 3, 5, 1, 2,
+            3, 4, 5, 6, 1, 9, 4, 8, 5, 9, 2, 4, 6, 8, 3, 5, 7, 9, 1, 2, 3, 4, 5, 6, 7, 8,
+            // 11 inputs, 38 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 1, 2, 5, 6, 9, 10, 0, 4, 3, 7, 1, 5, 2, 6, 9, 10, 0,
+            8, 2, 4, 3, 5, 1, 2, 3, 4, 5, 6, 1, 9, 2, 10, 4, 8, 5, 9, 6, 10, 2, 4, 3, 5, 6, 8, 7, 9, 1, 2, 3, 4, 5, 6, 7, 8,
+            9, 10,
+            // 12 inputs, 42 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 1, 2, 5, 6, 9, 10, 0, 4, 3, 7, 1, 5,
+            2, 6, 9, 10, 0, 8, 2, 4, 3, 5, 1, 2, 3, 4, 5, 6, 1, 9, 2, 10, 3, 11, 4, 8, 5, 9, 6, 10, 7, 11, 2, 4, 3, 5, 6, 8,
+            7, 9, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+            // 13 inputs, 48 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 1, 2, 5, 6, 9, 10, 0, 4, 3, 7, 8, 12,
+            1, 5, 2, 6, 10, 12, 0, 8, 2, 4, 3, 5, 9, 10, 11, 12, 1, 2, 3, 4, 5, 6, 1, 9, 2, 10, 3, 11, 4, 12, 4, 8, 5, 9, 6,
+            10, 7, 11, 2, 4, 3, 5, 6, 8, 7, 9, 10, 12, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+            // 14 inputs, 53 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 1, 2, 5, 6, 9, 10, 0, 4, 3,
+            7, 8, 12, 1, 5, 2, 6, 9, 13, 10, 12, 0, 8, 2, 4, 3, 5, 11, 13, 9, 10, 1, 2, 3, 4, 5, 6, 11, 12, 1, 9, 2, 10, 3,
+            11, 4, 12, 5, 13, 4, 8, 5, 9, 6, 10, 7, 11, 2, 4, 3, 5, 6, 8, 7, 9, 10, 12, 11, 13, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+            10, 11, 12,
+            // 15 inputs, 59 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 12, 14, 1, 2, 5, 6, 9, 10,
+            13, 14, 0, 4, 3, 7, 8, 12, 1, 5, 2, 6, 9, 13, 10, 14, 0, 8, 2, 4, 3, 5, 10, 12, 11, 13, 1, 2, 3, 4, 5, 6, 9, 10,
+            11, 12, 13, 14, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 4, 8, 5, 9, 6, 10, 7, 11, 2, 4, 3, 5, 6, 8, 7, 9, 10,
+            12, 11, 13, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+            // 16 inputs, 63 comparators
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 12, 14, 13, 15, 1, 2,
+            5, 6, 9, 10, 13, 14, 0, 4, 3, 7, 8, 12, 11, 15, 1, 5, 2, 6, 9, 13, 10, 14, 0, 8, 7, 15, 2, 4, 3, 5, 10, 12, 11,
+            13, 1, 2, 3, 4, 5, 6, 9, 10, 11, 12, 13, 14, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 4, 8, 5, 9, 6, 10, 7, 11,
+            2, 4, 3, 5, 6, 8, 7, 9, 10, 12, 11, 13, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+        };
+
+        inline constexpr uint16_t sort_network_start[] = {0,   0,   0,   1,   4,   9,   18,  30,  46, 65,
+                                                          93,  125, 163, 205, 253, 306, 365, 428};
+
+        template <typename It, typename C>
+        inline void compare_exchange(It a, It b, C& comp)
+        {
+            iter_value_t<It> x = *a, y = *b;
+            bool swapped = comp(y, x);
+            *a = swapped ? y : x;
+            *b = swapped ? x : y;
+        }
+
+        template <size_t N, typename It, typename C>
+        void sort_network(It first, C& comp)
+        {
+            constexpr size_t begin = sort_network_start[N], end = sort_network_start[N + 1];
+#pragma GCC unroll 64
+            for (size_t i = begin; i < end; i++)
+                compare_exchange(first + sort_networks[2 * i], first + sort_networks[2 * i + 1], comp);
+        }
+
+        // sorts n <= 16 elements; only for types where is_branchless_sort_v holds
+        template <typename It, typename C>
+        void sort_small(It first, size_t n, C& comp)
+        {
+            switch (n)
+            {
+            case 2: return sort_network<2>(first, comp);
+            case 3: return sort_network<3>(first, comp);
+            case 4: return sort_network<4>(first, comp);
+            case 5: return sort_network<5>(first, comp);
+            case 6: return sort_network<6>(first, comp);
+            case 7: return sort_network<7>(first, comp);
+            case 8: return sort_network<8>(first, comp);
+            case 9: return sort_network<9>(first, comp);
+            case 10: return sort_network<10>(first, comp);
+            case 11: return sort_network<11>(first, comp);
+            case 12: return sort_network<12>(first, comp);
+            case 13: return sort_network<13>(first, comp);
+            case 14: return sort_network<14>(first, comp);
+            case 15: return sort_network<15>(first, comp);
+            case 16: return sort_network<16>(first, comp);
+            default: return;
+            }
+        }
+
+        // stable
+        template <typename It, typename C>
+        void insertion_sort(It first, It last, C& comp)
+        {
+            if (first == last)
+                return;
+
+            for (It i = first + 1; i != last; ++i)
+            {
+                if (!comp(*i, *(i - 1)))
+                    continue;
+
+                iter_value_t<It> tmp(std::move(*i));
+                It j = i;
+                do
+                {
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (j != first && comp(tmp, *(j - 1)));
+                *j = std::move(tmp);
+            }
+        }
+
+        // insertion sort for a range whose predecessor is no greater than any of its elements, which stops the
+        // scan without a bounds check
+        template <typename It, typename C>
+        void unguarded_insertion_sort(It first, It last, C& comp)
+        {
+            if (first == last)
+                return;
+
+            for (It i = first + 1; i != last; ++i)
+            {
+                if (!comp(*i, *(i - 1)))
+                    continue;
+
+                iter_value_t<It> tmp(std::move(*i));
+                It j = i;
+                do
+                {
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (comp(tmp, *(j - 1)));
+                *j = std::move(tmp);
+            }
+        }
+
+        // insertion sort that gives up, returning false, once it has moved more than a few elements; a partition
+        // that was already in order is usually (nearly) sorted, and this finishes it in linear time
+        template <typename It, typename C>
+        bool partial_insertion_sort(It first, It last, C& comp)
+        {
+            if (first == last)
+                return true;
+
+            size_t moved = 0;
+            for (It i = first + 1; i != last; ++i)
+            {
+                if (!comp(*i, *(i - 1)))
+                    continue;
+
+                iter_value_t<It> tmp(std::move(*i));
+                It j = i;
+                do
+                {
+                    *j = std::move(*(j - 1));
+                    --j;
+                } while (j != first && comp(tmp, *(j - 1)));
+                *j = std::move(tmp);
+
+                moved += i - j;
+                if (moved > 8)
+                    return false;
+            }
+            return true;
+        }
+
+        template <typename It, typename C>
+        void sort2(It a, It b, C& comp)
+        {
+            if (comp(*b, *a))
+                swap(*a, *b);
+        }
+
+        template <typename It, typename C>
+        void sort3(It a, It b, It c, C& comp)
+        {
+            sort2(a, b, comp);
+            sort2(b, c, comp);
+            sort2(a, b, comp);
+        }
+
+        // Partitions [first, last) around the pivot *first into elements less than it, the pivot, and the rest, and
+        // returns the pivot's new position and whether nothing had to move
+        template <typename It, typename C>
+        pair<It, bool> pdq_partition_right(It first, It last, C& comp)
+        {
+            iter_value_t<It> pivot(std::move(*first));
+            It lo = first, hi = last;
+
+            // the median of three guarantees an element no less than the pivot on the right, which stops this scan
+            while (comp(*++lo, pivot))
+                ;
+            if (lo - 1 == first)
+                while (lo < hi && !comp(*--hi, pivot))
+                    ;
+            else
+                while (!comp(*--hi, pivot))
+                    ;
+
+            bool partitioned = lo >= hi;
+            while (lo < hi)
+            {
+                swap(*lo, *hi);
+                while (comp(*++lo, pivot))
+                    ;
+                while (!comp(*--hi, pivot))
+                    ;
+            }
+
+            It pivot_pos = lo - 1;
+            *first = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+            return {pivot_pos, partitioned};
+        }
+
+        // The same partition as pdq_partition_right, for cheap comparisons: each side is scanned in blocks of 64,
+        // recording the offsets of the elements on the wrong side with a branch free increment, and then the
+        // recorded elements are swapped in pairs. The comparisons no longer decide branches, so there is nothing to
+        // mispredict however random the input
+        template <typename It, typename C>
+        pair<It, bool> pdq_partition_right_branchless(It first, It last, C& comp)
+        {
+            constexpr size_t block = 64;
+
+            iter_value_t<It> pivot(std::move(*first));
+            It lo = first, hi = last;
+
+            while (comp(*++lo, pivot))
+                ;
+            if (lo - 1 == first)
+                while (lo < hi && !comp(*--hi, pivot))
+                    ;
+            else
+                while (!comp(*--hi, pivot))
+                    ;
+
+            bool partitioned = lo >= hi;
+            if (!partitioned)
+            {
+                swap(*lo, *hi);
+                ++lo;
+
+                alignas(64) uint8_t offsets_l[block];
+                alignas(64) uint8_t offsets_r[block];
+                It base_l = lo, base_r = hi;
+                size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+                while (lo < hi)
+                {
+                    // fill whichever buffers are empty, splitting what is left between them near the end
+                    size_t unknown = hi - lo;
+                    size_t split_l = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                    size_t split_r = num_r == 0 ? unknown - split_l : 0;
+                    split_l = split_l < block ? split_l : block;
+                    split_r = split_r < block ? split_r : block;
+
+                    for (size_t i = 0; i < split_l; i++)
+                    {
+                        offsets_l[num_l] = (uint8_t)i;
+                        num_l += !comp(*lo, pivot);
+                        ++lo;
+                    }
+
+                    for (size_t i = 0; i < split_r;)
+                    {
+                        offsets_r[num_r] = (uint8_t)++i;
+                        num_r += comp(*--hi, pivot);
+                    }
+
+                    size_t num = num_l < num_r ? num_l : num_r;
+                    for (size_t i = 0; i < num; i++)
+                        swap(*(base_l + offsets_l[start_l + i]), *(base_r - offsets_r[start_r + i]));
+
+                    num_l -= num;
+                    num_r -= num;
+                    start_l += num;
+                    start_r += num;
+                    if (num_l == 0)
+                    {
+                        start_l = 0;
+                        base_l = lo;
+                    }
+                    if (num_r == 0)
+                    {
+                        start_r = 0;
+                        base_r = hi;
+                    }
+                }
+
+                // one buffer may still hold elements; they go to the far end of the unscanned gap, which is empty
+                if (num_l)
+                {
+                    while (num_l--)
+                        swap(*(base_l + offsets_l[start_l + num_l]), *--hi);
+                    lo = hi;
+                }
+                if (num_r)
+                {
+                    while (num_r--)
+                    {
+                        swap(*(base_r - offsets_r[start_r + num_r]), *lo);
+                        ++lo;
+                    }
+                }
+            }
+
+            It pivot_pos = lo - 1;
+            *first = std::move(*pivot_pos);
+            *pivot_pos = std::move(pivot);
+            return {pivot_pos, partitioned};
+        }
+
+        // Puts the elements equal to the pivot *first on its left. Used when the pivot equals the element before
+        // the range, so that everything equal to it is finished in one step, which makes many duplicates linear
+        template <typename It, typename C>
+        It pdq_partition_left(It first, It last, C& comp)
+        {
+            iter_value_t<It> pivot(std::move(*first));
+            It lo = first, hi = last;
+
+            while (comp(pivot, *--hi))
+                ;
+            if (hi + 1 == last)
+                while (lo < hi && !comp(pivot, *++lo))
+                    ;
+            else
+                while (!comp(pivot, *++lo))
+                    ;
+
+            while (lo < hi)
+            {
+                swap(*lo, *hi);
+                while (comp(pivot, *--hi))
+                    ;
+                while (!comp(pivot, *++lo))
+                    ;
+            }
+
+            *first = std::move(*hi);
+            *hi = std::move(pivot);
+            return hi;
+        }
+
+        // Pattern-defeating quicksort (Orson Peters): introsort whose pivot is a median of three, or of three
+        // medians of three on large ranges; which notices partitions that needed no swaps and finishes them with a
+        // bounded insertion sort, so sorted and reverse sorted input is linear; which groups runs of equal elements
+        // in one pass; and which, when a partition comes out badly unbalanced, shuffles a few elements to break the
+        // pattern behind it, falling back to heap sort only after log2(n) such partitions
+        template <bool Branchless, typename It, typename C>
+        void pdqsort_loop(It first, It last, C& comp, int bad_allowed, bool leftmost)
+        {
+            constexpr iter_diff_t<It> insertion_threshold = 24, ninther_threshold = 128;
+
+            while (true)
+            {
+                iter_diff_t<It> n = last - first;
+
+                if (Branchless && n <= 16)
+                    return sort_small(first, n, comp);
+                if (n < insertion_threshold)
+                {
+                    if (leftmost)
+                        insertion_sort(first, last, comp);
+                    else
+                        unguarded_insertion_sort(first, last, comp);
+                    return;
+                }
+
+                // the pivot goes to *first
+                iter_diff_t<It> half = n / 2;
+                if (n > ninther_threshold)
+                {
+                    sort3(first, first + half, last - 1, comp);
+                    sort3(first + 1, first + (half - 1), last - 2, comp);
+                    sort3(first + 2, first + (half + 1), last - 3, comp);
+                    sort3(first + (half - 1), first + half, first + (half + 1), comp);
+                    swap(*first, *(first + half));
+                }
+                else
+                    sort3(first + half, first, last - 1, comp);
+
+                // a pivot equal to the element before the range, which is the pivot of an earlier partition, is the
+                // smallest value in the range, so the elements equal to it need no further sorting
+                if (!leftmost && !comp(*(first - 1), *first))
+                {
+                    first = pdq_partition_left(first, last, comp) + 1;
+                    continue;
+                }
+
+                pair<It, bool> part = Branchless ? pdq_partition_right_branchless(first, last, comp)
+                                                 : pdq_partition_right(first, last, comp);
+                It pivot = part.first;
+
+                iter_diff_t<It> n_l = pivot - first;
+                iter_diff_t<It> n_r = last - (pivot + 1);
+                if (n_l < n / 8 || n_r < n / 8)
+                {
+                    if (--bad_allowed == 0)
+                    {
+                        detail::make_heap<2>(first, last, comp);
+                        detail::sort_heap<2>(first, last, comp);
+                        return;
+                    }
+
+                    if (n_l >= insertion_threshold)
+                    {
+                        swap(*first, *(first + n_l / 4));
+                        swap(*(pivot - 1), *(pivot - n_l / 4));
+                        if (n_l > ninther_threshold)
+                        {
+                            swap(*(first + 1), *(first + (n_l / 4 + 1)));
+                            swap(*(first + 2), *(first + (n_l / 4 + 2)));
+                            swap(*(pivot - 2), *(pivot - (n_l / 4 + 1)));
+                            swap(*(pivot - 3), *(pivot - (n_l / 4 + 2)));
+                        }
+                    }
+
+                    if (n_r >= insertion_threshold)
+                    {
+                        swap(*(pivot + 1), *(pivot + (1 + n_r / 4)));
+                        swap(*(last - 1), *(last - n_r / 4));
+                        if (n_r > ninther_threshold)
+                        {
+                            swap(*(pivot + 2), *(pivot + (2 + n_r / 4)));
+                            swap(*(pivot + 3), *(pivot + (3 + n_r / 4)));
+                            swap(*(last - 2), *(last - (1 + n_r / 4)));
+                            swap(*(last - 3), *(last - (2 + n_r / 4)));
+                        }
+                    }
+                }
+                else if (part.second && partial_insertion_sort(first, pivot, comp) &&
+                         partial_insertion_sort(pivot + 1, last, comp))
+                    return;
+
+                // the left side recursively, the right side by looping
+                pdqsort_loop<Branchless>(first, pivot, comp, bad_allowed, leftmost);
+                first = pivot + 1;
+                leftmost = false;
+            }
+        }
+
+        template <typename It, typename C>
+        void pdqsort(It first, It last, C& comp)
+        {
+            if (last - first < 2)
+                return;
+            pdqsort_loop<is_branchless_sort_v<iter_value_t<It>, C>>(first, last, comp,
+                                                                    64 - __builtin_clzll(last - first), true);
+        }
+
+        // Merges [first, mid) and [mid, last) through buf, which holds room for mid - first elements; ties go to the
+        // left run, which keeps the merge stable
+        template <typename It, typename C>
+        void merge_with_buffer(It first, It mid, It last, C& comp, iter_value_t<It>* buf)
+        {
+            using T = iter_value_t<It>;
+
+            T* l = buf;
+            T* l_end = buf;
+            for (It i = first; i != mid; ++i, ++l_end)
+                construct_at(l_end, std::move(*i));
+
+            It r = mid, out = first;
+            if constexpr (is_branchless_sort_v<T, C>)
+            {
+                while (l != l_end && r != last)
+                {
+                    bool right = comp(*r, *l);
+                    *out++ = right ? *r : *l;
+                    r += right;
+                    l += !right;
+                }
+            }
+            else
+            {
+                while (l != l_end && r != last)
+                {
+                    if (comp(*r, *l))
+                        *out++ = std::move(*r++);
+                    else
+                        *out++ = std::move(*l++);
+                }
+            }
+
+            for (; l != l_end; ++l)
+                *out++ = std::move(*l);
+            for (T* i = buf; i != l_end; ++i)
+                destroy_at(i);
+        }
+
+        // top down merge sort over a buffer of half the range, with insertion sort below 24 elements; merging is
+        // skipped when the two halves are already in order
+        template <typename It, typename C>
+        void merge_sort(It first, It last, C& comp, iter_value_t<It>* buf)
+        {
+            iter_diff_t<It> n = last - first;
+            if (n < 24)
+                return insertion_sort(first, last, comp);
+
+            It mid = first + n / 2;
+            merge_sort(first, mid, comp, buf);
+            merge_sort(mid, last, comp, buf);
+            if (comp(*mid, *(mid - 1)))
+                merge_with_buffer(first, mid, last, comp, buf);
+        }
+
+        template <typename It, typename C>
+        void stable_sort(It first, It last, C& comp)
+        {
+            iter_diff_t<It> n = last - first;
+            if (n < 24)
+                return insertion_sort(first, last, comp);
+
+            iter_value_t<It>* buf = detail::allocate<iter_value_t<It>>(n / 2);
+            merge_sort(first, last, comp, buf);
+            detail::deallocate(buf);
+        }
+
+        template <size_t N>
+        struct radix_uint;
+        template <>
+        struct radix_uint<1>
+        {
+            using type = uint8_t;
+        };
+        template <>
+        struct radix_uint<2>
+        {
+            using type = uint16_t;
+        };
+        template <>
+        struct radix_uint<4>
+        {
+            using type = uint32_t;
+        };
+        template <>
+        struct radix_uint<8>
+        {
+            using type = uint64_t;
+        };
+
+        // k as an unsigned integer that orders the same way: signed integers get their sign bit flipped, floating
+        // point numbers that too if positive and every bit if negative
+        template <typename K>
+        auto radix_bits(K k)
+        {
+            static_assert(is_arithmetic_v<K> && sizeof(K) <= 8, "radix_sort keys must be integers or floats");
+            using U = typename radix_uint<sizeof(K)>::type;
+            constexpr U top = U(1) << (8 * sizeof(K) - 1);
+
+            U u;
+            __builtin_memcpy(&u, &k, sizeof(K));
+            if constexpr (is_floating_point_v<K>)
+                return U(u ^ (u & top ? U(~U(0)) : top));
+            else if constexpr (K(-1) < K(0))
+                return U(u ^ top);
+            else
+                return u;
+        }
+
+        // LSD radix sort, a byte per pass: one pass over the input counts every digit of every key, then each pass
+        // scatters the elements by one digit between the range and a buffer. Digits that are the same in every key
+        // are skipped, so small keys in a wide type cost only the passes they need. Stable
+        template <typename It, typename Key>
+        void radix_sort(It first, It last, Key& key)
+        {
+            using T = iter_value_t<It>;
+            using U = decltype(radix_bits(key(*first)));
+            constexpr size_t digits = sizeof(U);
+
+            size_t n = last - first;
+            if (n < 64)
+            {
+                auto comp = [&key](const T& a, const T& b) { return radix_bits(key(a)) < radix_bits(key(b)); };
+                return insertion_sort(first, last, comp);
+            }
+
+            size_t* counts = detail::allocate<size_t>(digits * 256);
+            for (size_t i = 0; i < digits * 256; i++)
+                counts[i] = 0;
+            for (It i = first; i != last; ++i)
+            {
+                U k = radix_bits(key(*i));
+                for (size_t d = 0; d < digits; d++)
+                    counts[d * 256 + (k >> (8 * d) & 0xff)]++;
+            }
+
+            T* buf = detail::allocate<T>(n);
+            bool buf_live = false, in_buf = false;
+
+            auto scatter = [&](auto src, auto dst, size_t* offsets, size_t d, bool construct) {
+                for (size_t i = 0; i < n; i++)
+                {
+                    size_t& at = offsets[radix_bits(key(src[i])) >> (8 * d) & 0xff];
+                    if (construct)
+                        construct_at(&dst[at++], std::move(src[i]));
+                    else
+                        dst[at++] = std::move(src[i]);
+                }
+            };
+
+            for (size_t d = 0; d < digits; d++)
+            {
+                size_t* offsets = counts + d * 256;
+                bool trivial = false;
+                size_t sum = 0;
+                for (size_t b = 0; b < 256; b++)
+                {
+                    trivial |= offsets[b] == n;
+                    size_t c = offsets[b];
+                    offsets[b] = sum;
+                    sum += c;
+                }
+                if (trivial)
+                    continue;
+
+                if (in_buf)
+                    scatter(buf, first, offsets, d, false);
+                else
+                    scatter(first, buf, offsets, d, !buf_live);
+                buf_live = true;
+                in_buf = !in_buf;
+            }
+
+            if (in_buf)
+                for (size_t i = 0; i < n; i++)
+                    first[i] = std::move(buf[i]);
+            if (buf_live)
+                for (size_t i = 0; i < n; i++)
+                    destroy_at(buf + i);
+            detail::deallocate(buf);
+            detail::deallocate(counts);
+        }
+    } // namespace detail
+} // namespace std
+
+#endif
@@ -0,0 +1,673 @@
+#ifndef __NOSTDLIB_SWISS_TABLE_H__
+#define __NOSTDLIB_SWISS_TABLE_H__
+#include "hash.h"
+#include "iterator_simple_types.h"
+#include "uninitialized.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace std::detail
+{
+    // Every slot of a swiss table has a control byte: the low 7 bits of the hash (H2) when the slot is full, or one
+    // of these. A sentinel follows the last slot so that iteration stops without checking bounds
+    inline constexpr int8_t SWISS_EMPTY = -128;
+    inline constexpr int8_t SWISS_DELETED = -2;
+    inline constexpr int8_t SWISS_SENTINEL = -1;
+
+    inline bool swiss_is_full(int8_t c) { return c >= 0; }
+
+    // the bits of a group match, one per slot, or one per byte with SHIFT = 3 for the portable group
+    template <size_t WIDTH, int SHIFT>
+    struct swiss_bitmask
+    {
+        uint64_t bits;
+
+        explicit operator bool() const { return bits; }
+        size_t lowest() const { return __builtin_ctzll(bits) >> SHIFT; }
+        void next() { bits &= bits - 1; }
+
+        // the number of unmatched slots at the start and at the end of the group
+        size_t trailing_zeros() const { return __builtin_ctzll(bits) >> SHIFT; }
+        size_t leading_zeros() const { return (__builtin_clzll(bits) - (64 - (WIDTH << SHIFT))) >> SHIFT; }
+    };
+
+#ifdef __SSE2__
+    // a group of control bytes probed with one SSE2 compare and pmovmskb each
+    struct swiss_group
+    {
+        static constexpr size_t WIDTH = 16;
+        using mask = swiss_bitmask<16, 0>;
+        using vec = char __attribute__((vector_size(16)));
+
+        vec ctrl;
+
+        explicit swiss_group(const int8_t* p) { __builtin_memcpy(&ctrl, p, 16); }
+
+        static uint64_t movemask(vec v) { return (uint16_t)__builtin_ia32_pmovmskb128(v); }
+
+        mask match(int8_t h2) const { return {movemask((vec)(ctrl == (char)h2))}; }
+        mask match_empty() const { return {movemask((vec)(ctrl == (char)SWISS_EMPTY))}; }
+        // the sentinel is the only control byte above deleted that is not full
+        mask match_empty_or_deleted() const { return {movemask((vec)(ctrl < (char)SWISS_SENTINEL))}; }
+
+        size_t count_leading_empty_or_deleted() const
+        {
+            return __builtin_ctzll(~match_empty_or_deleted().bits | (1ull << WIDTH));
+        }
+    };
+#else
+    // the same over 8 control bytes in a word, with bit tricks that may report false positives for match, which the
+    // key comparison weeds out
+    struct swiss_group
+    {
+        static constexpr size_t WIDTH = 8;
+        using mask = swiss_bitmask<8, 3>;
+        static constexpr uint64_t LSBS = 0x0101010101010101;
+        static constexpr uint64_t MSBS = 0x8080808080808080;
+
+        uint64_t ctrl;
+
+        explicit swiss_group(const int8_t* p) { __builtin_memcpy(&ctrl, p, 8); }
+
+        mask match(int8_t h2) const
+        {
+            uint64_t x = ctrl ^ (LSBS * (uint8_t)h2);
+            return {(x - LSBS) & ~x & MSBS};
+        }
+
+        // empty is the only control byte with the high bit set and bit 1 clear, deleted and empty the only ones with
+        // the high bit set and bit 0 clear
+        mask match_empty() const { return {ctrl & ~(ctrl << 6) & MSBS}; }
+        mask match_empty_or_deleted() const { return {ctrl & ~(ctrl << 7) & MSBS}; }
+
+        size_t count_leading_empty_or_deleted() const
+        {
+            uint64_t stop = ~match_empty_or_deleted().bits & MSBS;
+            return stop ? __builtin_ctzll(stop) >> 3 : WIDTH;
+        }
+    };
+#endif
+
+    // control bytes of a table without slots: lookups see an empty slot right away and iteration the sentinel
+    alignas(16) inline constexpr int8_t swiss_empty_group[16] = {
+        SWISS_SENTINEL, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY,
+        SWISS_EMPTY,    SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY, SWISS_EMPTY};
+
+    // Slot is Value itself for flat tables and Value* for tables that keep every value in its own allocation
+    template <typename Slot, typename Value, bool Const>
+    class swiss_iterator
+    {
+        template <typename, typename, typename, typename, typename, bool>
+        friend class swiss_table;
+        template <typename, typename, bool>
+        friend class swiss_iterator;
+
+        int8_t* ctrl;
+        Slot* slot;
+
+        swiss_iterator(int8_t* c, Slot* s) noexcept : ctrl(c), slot(s) {}
+
+        void skip_empty_or_deleted()
+        {
+            while (*ctrl < SWISS_SENTINEL)
+            {
+                size_t n = swiss_group(ctrl).count_leading_empty_or_deleted();
+                ctrl += n;
+                slot += n;
+            }
+        }
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = ptrdiff_t;
+        using reference = conditional_t<Const, const Value&, Value&>;
+        using pointer = conditional_t<Const, const Value*, Value*>;
+
+        constexpr swiss_iterator() noexcept : ctrl(nullptr), slot(nullptr) {}
+        template <bool C, typename = enable_if_t<Const && !C>>
+        swiss_iterator(const swiss_iterator<Slot, Value, C>& i) noexcept : ctrl(i.ctrl), slot(i.slot)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            if constexpr (is_same_v<Slot, Value>)
+                return *slot;
+            else
+                return **slot;
+        }
+
+        pointer operator->() const noexcept { return &**this; }
+
+        swiss_iterator& operator++() noexcept
+        {
+            ++ctrl;
+            ++slot;
+            skip_empty_or_deleted();
+            return *this;
+        }
+
+        swiss_iterator operator++(int) noexcept
+        {
+            swiss_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const swiss_iterator<Slot, Value, C>& rhs) const noexcept
+        {
+            return ctrl == rhs.ctrl;
+        }
+
+        template <bool C>
+        bool operator!=(const swiss_iterator<Slot, Value, C>& rhs) const noexcept
+        {
+            return ctrl != rhs.ctrl;
+        }
+    };
+
+    // An open addressing hash table in the style of Abseil's swiss tables, behind unordered_map, unordered_set and
+    // their flat variants.
+    // Slots are probed a group at a time: one compare of the group's control bytes against the H2 of the hash
+    // finds every candidate, so a lookup touches about one cache line of control bytes and then only slots whose
+    // 7 hash bits match. The capacity is a power of two minus one, and the table grows at 7/8 load.
+    // Erasing leaves a tombstone only when the slot sits in a run of full groups that a probe may have passed
+    // through; otherwise the slot goes back to empty and lookups stay short.
+    // Flat tables store the values in the slot array, so rehashing moves them; the others store pointers to
+    // separately allocated values, which never move
+    template <typename Key, typename Value, typename KeyOfValue, typename Hash, typename Eq, bool Flat>
+    class swiss_table
+    {
+        template <typename, typename, typename, typename, typename, bool>
+        friend class swiss_table;
+
+        using slot_type = conditional_t<Flat, Value, Value*>;
+        static constexpr size_t WIDTH = swiss_group::WIDTH;
+        static constexpr size_t npos = (size_t)-1;
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = Eq;
+        // set elements are their own keys and stay const
+        using iterator = swiss_iterator<slot_type, Value, is_same_v<Key, Value>>;
+        using const_iterator = swiss_iterator<slot_type, Value, true>;
+
+    private:
+        int8_t* ctrl;
+        slot_type* slots;
+        size_t cap;
+        size_t s;
+        // inserts left before the next rehash: the empty slots under the load limit
+        size_t growth_left;
+        Hash hash_fn;
+        Eq eq;
+
+        static const Key& key_of(const Value& v) { return KeyOfValue()(v); }
+
+        static Value* value_of(slot_type* slot)
+        {
+            if constexpr (Flat)
+                return slot;
+            else
+                return *slot;
+        }
+
+        // user hashes may be as weak as the identity; a 128-bit multiply spreads every input bit over the result
+        template <typename K>
+        size_t hash_of(const K& k) const
+        {
+            uint64_t h = hash_fn(k);
+#ifdef __SIZEOF_INT128__
+            __uint128_t m = (__uint128_t)h * 0x9e3779b97f4a7c15;
+            return (size_t)((uint64_t)m ^ (uint64_t)(m >> 64));
+#else
+            h *= 0x9e3779b97f4a7c15;
+            return (size_t)(h ^ (h >> 32));
+#endif
+        }
+
+        static size_t h1(size_t h) { return h >> 7; }
+        static int8_t h2(size_t h) { return h & 0x7f; }
+
+        // how many elements a table of capacity c holds before growing
+        static size_t growth_of(size_t c) { return WIDTH == 8 && c == 7 ? 6 : c - c / 8; }
+
+        static size_t capacity_for(size_t n)
+        {
+            size_t c = 1;
+            while (growth_of(c) < n)
+                c = c * 2 + 1;
+            return c;
+        }
+
+        // also sets the copy of the byte that mirrors the first group after the sentinel, so that a group loaded
+        // near the end wraps around
+        void set_ctrl(size_t i, int8_t c)
+        {
+            ctrl[i] = c;
+            ctrl[((i - (WIDTH - 1)) & cap) + ((WIDTH - 1) & cap)] = c;
+        }
+
+        // one allocation holds the slots followed by cap + WIDTH control bytes
+        void allocate_table(size_t c)
+        {
+            size_t ctrl_slots = (c + WIDTH + sizeof(slot_type) - 1) / sizeof(slot_type);
+            slots = detail::allocate<slot_type>(c + ctrl_slots);
+            ctrl = (int8_t*)(slots + c);
+            cap = c;
+            __builtin_memset(ctrl, SWISS_EMPTY, c + WIDTH);
+            ctrl[c] = SWISS_SENTINEL;
+            growth_left = growth_of(c) - s;
+        }
+
+        void reset_empty()
+        {
+            ctrl = (int8_t*)swiss_empty_group;
+            slots = nullptr;
+            cap = 0;
+            s = 0;
+            growth_left = 0;
+        }
+
+        void destroy_slot(slot_type* slot)
+        {
+            if constexpr (Flat)
+                destroy_at(slot);
+            else
+            {
+                destroy_at(*slot);
+                detail::deallocate(*slot);
+            }
+        }
+
+        void destroy_all()
+        {
+            if constexpr (!Flat || !is_trivially_destructible_v<Value>)
+                for (size_t i = 0; i < cap; i++)
+                    if (swiss_is_full(ctrl[i]))
+                        destroy_slot(slots + i);
+        }
+
+        template <typename... Args>
+        void construct_slot(size_t i, Args&&... args)
+        {
+            if constexpr (Flat)
+                construct_at(slots + i, std::forward<Args>(args)...);
+            else
+                slots[i] = construct_at(detail::allocate<Value>(1), std::forward<Args>(args)...);
+        }
+
+        template <typename K>
+        size_t find_index(const K& k) const
+        {
+            size_t h = hash_of(k);
+            size_t offset = h1(h) & cap;
+            for (size_t step = WIDTH;; step += WIDTH)
+            {
+                swiss_group g(ctrl + offset);
+                for (auto m = g.match(h2(h)); m; m.next())
+                {
+                    size_t i = (offset + m.lowest()) & cap;
+                    if (eq(key_of(*value_of(slots + i)), k))
+                        return i;
+                }
+
+                if (g.match_empty())
+                    return npos;
+                offset = (offset + step) & cap;
+            }
+        }
+
+        size_t find_first_non_full(size_t h) const
+        {
+            size_t offset = h1(h) & cap;
+            for (size_t step = WIDTH;; step += WIDTH)
+            {
+                auto m = swiss_group(ctrl + offset).match_empty_or_deleted();
+                if (m)
+                    return (offset + m.lowest()) & cap;
+                offset = (offset + step) & cap;
+            }
+        }
+
+        void resize(size_t new_cap)
+        {
+            int8_t* old_ctrl = ctrl;
+            slot_type* old_slots = slots;
+            size_t old_cap = cap;
+            allocate_table(new_cap);
+
+            for (size_t i = 0; i < old_cap; i++)
+            {
+                if (!swiss_is_full(old_ctrl[i]))
+                    continue;
+
+                size_t h = hash_of(key_of(*value_of(old_slots + i)));
+                size_t j = find_first_non_full(h);
+                set_ctrl(j, h2(h));
+                if constexpr (Flat)
+                    detail::relocate(slots + j, old_slots + i, 1);
+                else
+                    slots[j] = old_slots[i];
+            }
+
+            if (old_cap)
+                detail::deallocate(old_slots);
+        }
+
+        // a table full of tombstones is rehashed at the same size, anything else doubles
+        void rehash_and_grow()
+        {
+            if (cap > WIDTH && s * 32 <= cap * 25)
+                resize(cap);
+            else
+                resize(cap * 2 + 1);
+        }
+
+        // claims a slot for a new element with hash h; the caller constructs the element in it
+        size_t prepare_insert(size_t h)
+        {
+            size_t i = find_first_non_full(h);
+            if (!growth_left && ctrl[i] != SWISS_DELETED)
+            {
+                rehash_and_grow();
+                i = find_first_non_full(h);
+            }
+
+            growth_left -= ctrl[i] == SWISS_EMPTY;
+            set_ctrl(i, h2(h));
+            s++;
+            return i;
+        }
+
+        void erase_meta(size_t i)
+        {
+            s--;
+
+            // if no group containing slot i is full, no probe ever went past i, and it can simply become empty
+            size_t before = (i - WIDTH) & cap;
+            auto empty_before = swiss_group(ctrl + before).match_empty();
+            auto empty_after = swiss_group(ctrl + i).match_empty();
+            bool never_full = empty_before && empty_after &&
+                              empty_after.trailing_zeros() + empty_before.leading_zeros() < WIDTH;
+
+            set_ctrl(i, never_full ? SWISS_EMPTY : SWISS_DELETED);
+            growth_left += never_full;
+        }
+
+        void copy_from(const swiss_table& other)
+        {
+            if (!other.s)
+                return;
+
+            s = other.s;
+            allocate_table(other.cap);
+            __builtin_memcpy(ctrl, other.ctrl, cap + WIDTH);
+            growth_left = other.growth_left;
+            for (size_t i = 0; i < cap; i++)
+                if (swiss_is_full(ctrl[i]))
+                    construct_slot(i, *value_of(other.slots + i));
+        }
+
+        void release()
+        {
+            destroy_all();
+            if (cap)
+                detail::deallocate(slots);
+            reset_empty();
+        }
+
+        void steal(swiss_table& other)
+        {
+            ctrl = other.ctrl;
+            slots = other.slots;
+            cap = other.cap;
+            s = other.s;
+            growth_left = other.growth_left;
+            other.reset_empty();
+        }
+
+    public:
+        explicit swiss_table(size_t bucket_count = 0, const Hash& h = Hash(), const Eq& e = Eq())
+            : hash_fn(h), eq(e)
+        {
+            reset_empty();
+            if (bucket_count)
+                reserve(bucket_count);
+        }
+
+        swiss_table(const swiss_table& other) : swiss_table(0, other.hash_fn, other.eq) { copy_from(other); }
+        swiss_table(swiss_table&& other) : hash_fn(other.hash_fn), eq(other.eq) { steal(other); }
+
+        ~swiss_table() { release(); }
+
+        swiss_table& operator=(const swiss_table& other)
+        {
+            if (this != &other)
+            {
+                release();
+                hash_fn = other.hash_fn;
+                eq = other.eq;
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        swiss_table& operator=(swiss_table&& other)
+        {
+            if (this != &other)
+            {
+                release();
+                hash_fn = other.hash_fn;
+                eq = other.eq;
+                steal(other);
+            }
+            return *this;
+        }
+
+        iterator begin() const
+        {
+            iterator it(ctrl, slots);
+            it.skip_empty_or_deleted();
+            return it;
+        }
+
+        iterator end() const { return iterator_at(cap); }
+
+        [[nodiscard]] bool empty() const noexcept { return s == 0; }
+        size_type size() const noexcept { return s; }
+        size_type max_size() const noexcept { return (size_type)-1 / sizeof(slot_type) / 2; }
+        size_type capacity() const noexcept { return cap; }
+        hasher hash_function() const { return hash_fn; }
+        key_equal key_eq() const { return eq; }
+
+        // keeps the slot array for reuse
+        void clear()
+        {
+            destroy_all();
+            if (cap)
+            {
+                __builtin_memset(ctrl, SWISS_EMPTY, cap + WIDTH);
+                ctrl[cap] = SWISS_SENTINEL;
+            }
+            s = 0;
+            growth_left = growth_of(cap);
+        }
+
+        void swap(swiss_table& other)
+        {
+            swiss_table tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        // makes room for n elements in total without rehashing
+        void reserve(size_t n)
+        {
+            if (n > s + growth_left)
+                resize(capacity_for(n));
+        }
+
+        // resizes to at least n slots, or shrinks to fit the elements if n is smaller
+        void rehash(size_t n)
+        {
+            if (!n && !s)
+            {
+                release();
+                return;
+            }
+
+            size_t c = capacity_for(s);
+            while (c < n)
+                c = c * 2 + 1;
+            if (c != cap)
+                resize(c);
+        }
+
+        // the slot holding key k, and whether it was claimed for a new element that the caller must now construct
+        // with emplace_at. Lets map::try_emplace construct the value only once it knows the key is new
+        template <typename K>
+        pair<size_t, bool> find_or_prepare_insert(const K& k)
+        {
+            size_t i = find_index(k);
+            if (i != npos)
+                return {i, false};
+            return {prepare_insert(hash_of(k)), true};
+        }
+
+        template <typename... Args>
+        iterator emplace_at(size_t i, Args&&... args)
+        {
+            construct_slot(i, std::forward<Args>(args)...);
+            return iterator_at(i);
+        }
+
+        iterator iterator_at(size_t i) const { return iterator(ctrl + i, slots + i); }
+
+        template <typename V>
+        pair<iterator, bool> insert(V&& v)
+        {
+            auto [i, inserted] = find_or_prepare_insert(key_of(v));
+            if (inserted)
+                construct_slot(i, std::forward<V>(v));
+            return {iterator_at(i), inserted};
+        }
+
+        // the key is only known once the value is built, so it is built outside the table first
+        template <typename... Args>
+        pair<iterator, bool> emplace(Args&&... args)
+        {
+            if constexpr (Flat)
+            {
+                alignas(Value) unsigned char buffer[sizeof(Value)];
+                Value* v = construct_at((Value*)buffer, std::forward<Args>(args)...);
+                auto [i, inserted] = find_or_prepare_insert(key_of(*v));
+                if (inserted)
+                    detail::relocate(slots + i, v, 1);
+                else
+                    destroy_at(v);
+                return {iterator_at(i), inserted};
+            }
+            else
+            {
+                Value* v = construct_at(detail::allocate<Value>(1), std::forward<Args>(args)...);
+                auto [i, inserted] = find_or_prepare_insert(key_of(*v));
+                if (inserted)
+                    slots[i] = v;
+                else
+                {
+                    destroy_at(v);
+                    detail::deallocate(v);
+                }
+                return {iterator_at(i), inserted};
+            }
+        }
+
+        // erasing never moves other elements, so iterators other than pos stay valid
+        iterator erase(const_iterator pos)
+        {
+            size_t i = pos.ctrl - ctrl;
+            destroy_slot(slots + i);
+            erase_meta(i);
+            iterator next = iterator_at(i);
+            next.skip_empty_or_deleted();
+            return next;
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            while (first != last)
+                first = erase(first);
+            return iterator_at(last.ctrl - ctrl);
+        }
+
+        template <typename K>
+        size_type erase_key(const K& k)
+        {
+            size_t i = find_index(k);
+            if (i == npos)
+                return 0;
+            destroy_slot(slots + i);
+            erase_meta(i);
+            return 1;
+        }
+
+        template <typename K>
+        iterator find(const K& k) const
+        {
+            size_t i = find_index(k);
+            return i == npos ? end() : iterator_at(i);
+        }
+
+        template <typename K>
+        size_type count(const K& k) const
+        {
+            return find_index(k) != npos;
+        }
+
+        // moves the elements of other whose keys are not present here over to this table; node tables pass the
+        // allocations along
+        template <typename H, typename E>
+        void merge(swiss_table<Key, Value, KeyOfValue, H, E, Flat>& other)
+        {
+            for (auto it = other.begin(); it != other.end();)
+            {
+                auto [i, inserted] = find_or_prepare_insert(key_of(*it));
+                if (!inserted)
+                {
+                    ++it;
+                    continue;
+                }
+
+                if constexpr (Flat)
+                {
+                    construct_slot(i, std::move(*it));
+                    it = other.erase(it);
+                }
+                else
+                {
+                    slots[i] = *it.slot;
+                    size_t j = it.ctrl - other.ctrl;
+                    other.erase_meta(j);
+                    it = other.iterator_at(j);
+                    it.skip_empty_or_deleted();
+                }
+            }
+        }
+
+        size_type bucket_count() const noexcept { return cap; }
+        float load_factor() const noexcept { return cap ? (float)s / cap : 0; }
+        float max_load_factor() const noexcept { return 7.0f / 8; }
+    };
+} // namespace std::detail
+
+#endif
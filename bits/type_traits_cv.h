@@ -92,7 +92,9 @@ namespace std
 
     template <typename T>
     struct is_integral
-        : matches_any<is_same, remove_cv_t<T>, bool, char, char32_t, wchar_t, short, int, long, long long, __int128>
+        : matches_any<is_same, remove_cv_t<T>, bool, char, signed char, unsigned char, char16_t, char32_t, wchar_t, short,
+                      unsigned short, int, unsigned int, long, unsigned long, long long, unsigned long long, __int128,
+                      unsigned __int128>
     {
     };
     template <typename T>
@@ -197,11 +197,11 @@ namespace std
     using is_nothrow_destructible = bool_constant<detail::is_nothrow_destructible_helper<T>()>;
 
     template <typename T>
-    inline constexpr bool is_destructible_v = is_move_assignable<T>::value;
+    inline constexpr bool is_destructible_v = is_destructible<T>::value;
     template <typename T>
-    inline constexpr bool is_trivially_destructible_v = is_trivially_move_assignable<T>::value;
+    inline constexpr bool is_trivially_destructible_v = is_trivially_destructible<T>::value;
     template <typename T>
-    inline constexpr bool is_nothrow_destructible_v = is_nothrow_move_assignable<T>::value;
+    inline constexpr bool is_nothrow_destructible_v = is_nothrow_destructible<T>::value;
 
     template <typename T>
 #if (__has_builtin(__has_trivial_destructor))
@@ -28,7 +28,7 @@ namespace std
 
     // effectively preforms an OR operation on all T::value in all Ts
     template <typename... Ts>
-    using disjunction = bool_constant<(Ts::value && ...)>;
+    using disjunction = bool_constant<(Ts::value || ...)>;
     template <typename... Ts>
     inline constexpr bool disjunction_v = disjunction<Ts...>::value;
 
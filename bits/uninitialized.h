@@ -0,0 +1,207 @@
+#ifndef __NOSTDLIB_BITS_UNINITIALIZED_H__
+#define __NOSTDLIB_BITS_UNINITIALIZED_H__
+#include "iterator_simple_types.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace std
+{
+    // Whether moving a T to a new address and ending the lifetime of the old one is equivalent to copying its bytes.
+    // True for trivially copyable types; specialize it for types that own resources but do not point into
+    // themselves (e.g. vector, unique_ptr) to let containers grow them with memcpy
+    template <typename T>
+    struct is_trivially_relocatable : bool_constant<is_trivially_copyable_v<T>>
+    {
+    };
+    template <typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    // pair is not trivially copyable because of its assignment operators, but moving its bytes is fine if it is
+    // fine for both members
+    template <typename T1, typename T2>
+    struct is_trivially_relocatable<pair<T1, T2>>
+        : bool_constant<is_trivially_relocatable_v<T1> && is_trivially_relocatable_v<T2>>
+    {
+    };
+
+    template <typename T, typename... Args>
+    T* construct_at(T* p, Args&&... args)
+    {
+        return new ((void*)p) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroy_at(T* p)
+    {
+        p->~T();
+    }
+
+    template <typename It>
+    void destroy(It first, It last)
+    {
+        if constexpr (!is_trivially_destructible_v<typename iterator_traits<It>::value_type>)
+            for (; first != last; ++first)
+                destroy_at(&*first);
+    }
+
+    template <typename It>
+    It destroy_n(It first, size_t n)
+    {
+        if constexpr (is_trivially_destructible_v<typename iterator_traits<It>::value_type>)
+            return first + n;
+        for (; n; n--, ++first)
+            destroy_at(&*first);
+        return first;
+    }
+
+    namespace detail
+    {
+        // the copy from In to Out can be a memcpy
+        template <typename In, typename Out, typename T = remove_cv_t<remove_pointer_t<Out>>>
+        inline constexpr bool is_bitwise_copy_v = is_pointer_v<In> && is_pointer_v<Out> &&
+                                                  is_same_v<remove_cv_t<remove_pointer_t<In>>, T> &&
+                                                  is_trivially_copyable_v<T>;
+    } // namespace detail
+
+    template <typename In, typename Out>
+    Out uninitialized_copy(In first, In last, Out dest)
+    {
+        if constexpr (detail::is_bitwise_copy_v<In, Out>)
+        {
+            // an empty range may be a pair of null pointers, which memcpy must not be given
+            if (first != last)
+                __builtin_memcpy((void*)dest, (const void*)first, (last - first) * sizeof(*first));
+            return dest + (last - first);
+        }
+        else
+        {
+            for (; first != last; ++first, ++dest)
+                construct_at(&*dest, *first);
+            return dest;
+        }
+    }
+
+    template <typename In, typename Out>
+    Out uninitialized_copy_n(In first, size_t n, Out dest)
+    {
+        if constexpr (detail::is_bitwise_copy_v<In, Out>)
+            return uninitialized_copy(first, first + n, dest);
+
+        for (; n; n--, ++first, ++dest)
+            construct_at(&*dest, *first);
+        return dest;
+    }
+
+    template <typename In, typename Out>
+    Out uninitialized_move(In first, In last, Out dest)
+    {
+        if constexpr (detail::is_bitwise_copy_v<In, Out>)
+            return uninitialized_copy(first, last, dest);
+
+        for (; first != last; ++first, ++dest)
+            construct_at(&*dest, std::move(*first));
+        return dest;
+    }
+
+    template <typename In, typename Out>
+    Out uninitialized_move_n(In first, size_t n, Out dest)
+    {
+        if constexpr (detail::is_bitwise_copy_v<In, Out>)
+            return uninitialized_copy(first, first + n, dest);
+
+        for (; n; n--, ++first, ++dest)
+            construct_at(&*dest, std::move(*first));
+        return dest;
+    }
+
+    template <typename It, typename T>
+    It uninitialized_fill_n(It first, size_t n, const T& value)
+    {
+        for (; n; n--, ++first)
+            construct_at(&*first, value);
+        return first;
+    }
+
+    template <typename It, typename T>
+    void uninitialized_fill(It first, It last, const T& value)
+    {
+        for (; first != last; ++first)
+            construct_at(&*first, value);
+    }
+
+    template <typename It>
+    It uninitialized_value_construct_n(It first, size_t n)
+    {
+        using T = typename iterator_traits<It>::value_type;
+        if constexpr (is_pointer_v<It> && is_trivially_default_constructible_v<T>)
+        {
+            if (n)
+                __builtin_memset((void*)first, 0, n * sizeof(T));
+            return first + n;
+        }
+
+        for (; n; n--, ++first)
+            construct_at(&*first);
+        return first;
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        T* allocate(size_t n)
+        {
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return (T*)::operator new(n * sizeof(T), align_val_t(alignof(T)));
+            else
+                return (T*)::operator new(n * sizeof(T));
+        }
+
+        template <typename T>
+        void deallocate(T* p)
+        {
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                ::operator delete((void*)p, align_val_t(alignof(T)));
+            else
+                ::operator delete((void*)p);
+        }
+
+        // moves n objects from src to dest and ends their lifetime at src, leaving src uninitialized
+        // dest may overlap src as long as it is below it
+        template <typename T>
+        void relocate(T* dest, T* src, size_t n)
+        {
+            if constexpr (is_trivially_relocatable_v<T>)
+            {
+                if (n)
+                    __builtin_memmove((void*)dest, (const void*)src, n * sizeof(T));
+            }
+            else
+                for (size_t i = 0; i < n; i++)
+                {
+                    construct_at(dest + i, std::move(src[i]));
+                    destroy_at(src + i);
+                }
+        }
+
+        // same as relocate, for a dest above src
+        template <typename T>
+        void relocate_backward(T* dest, T* src, size_t n)
+        {
+            if constexpr (is_trivially_relocatable_v<T>)
+            {
+                if (n)
+                    __builtin_memmove((void*)dest, (const void*)src, n * sizeof(T));
+            }
+            else
+                for (size_t i = n; i--;)
+                {
+                    construct_at(dest + i, std::move(src[i]));
+                    destroy_at(src + i);
+                }
+        }
+    } // namespace detail
+} // namespace std
+
+#endif
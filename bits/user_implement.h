@@ -1,16 +1,33 @@
 #ifndef __NOSTDLIB_USER_IMPLEMENT_H__
 #define __NOSTDLIB_USER_IMPLEMENT_H__
 #include <cstddef>
+#include <cstdint>
 namespace std::detail
 {
     void* malloc(size_t size);
     void* aligned_malloc(size_t size, size_t align);
     void free(void*);
     void putc(char ch);
+    size_t cpu_id();
+
+    // Threads for the parallel algorithms. thread_spawn starts fn(arg) on a new thread and returns a handle for
+    // thread_join, or nullptr if no thread could be started, in which case the caller does the work itself.
+    // cpu_count is how many threads are worth running at once. src/thread.cpp implements all three with pthreads
+    // where <pthread.h> exists, as weak symbols that a definition of your own replaces
+    void* thread_spawn(void (*fn)(void*), void* arg);
+    void thread_join(void* thread);
+    size_t cpu_count();
+
+    // Parking for atomic wait. futex_wait blocks while *addr == expected, until a futex_wake on addr; it may return
+    // early for any reason. futex_wake wakes up to count threads blocked on addr. src/thread.cpp implements both
+    // with the Linux futex syscall where its headers exist, as weak symbols
+    void futex_wait(const volatile uint32_t* addr, uint32_t expected);
+    void futex_wake(const volatile uint32_t* addr, int count);
 
     namespace errors
     {
         [[noreturn]] void __stdexcept_out_of_range();
+        [[noreturn]] void __stdexcept_overflow_error();
         [[noreturn]] void __stdexcept_bad_alloc();
         [[noreturn]] void __stdexcept_bad_variant_access();
         [[noreturn]] void __printf_argument_notfound();
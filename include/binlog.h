@@ -0,0 +1,304 @@
+#ifndef __NOSTDLIB_BINLOG_H__
+#define __NOSTDLIB_BINLOG_H__
+#include "../bits/user_implement.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <printf.h>
+#include <type_traits>
+
+// Deferred binary logging
+//
+// BINLOG(fmt, args...) records the address of a static call site descriptor, a TSC timestamp and the raw bytes of
+// the (promoted) arguments into the ring of the current cpu. Nothing is formatted on the hot path; a consumer calls
+// binlog::drain() later, which replays every record through printf_callback in timestamp order.
+//
+// Since only the pointer of an argument is recorded, %s arguments must point to storage that outlives the record
+// (string literals, static tables).
+#define BINLOG(fmt, ...)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static constexpr ::std::binlog::site __binlog_site{                                                            \
+            fmt, &decltype(::std::detail::binlog::make_codec(__VA_ARGS__))::decode};                                   \
+        ::std::binlog::write(&__binlog_site, ##__VA_ARGS__);                                                           \
+    } while (0)
+
+namespace std
+{
+    namespace binlog
+    {
+        inline constexpr size_t MAX_CPUS = 64;
+
+        using sink_t = void (*)(char, void*);
+        using decoder_t = void (*)(sink_t, void*, const char*, const char*);
+
+        // one per BINLOG() call site, lives in .rodata; its address is the format ID stored in each record
+        struct site
+        {
+            const char* fmt;
+            decoder_t decode;
+        };
+    } // namespace binlog
+
+    namespace detail::binlog
+    {
+        struct record
+        {
+            // total size of the record including the header, written last with release semantics.
+            // zero means "not yet committed", PADDING marks the unused tail of the ring before a wrap
+            uint32_t size;
+            uint32_t reserved;
+            const std::binlog::site* id;
+            uint64_t tsc;
+        };
+
+        inline constexpr uint32_t PADDING = 1U << 31;
+        inline constexpr size_t ALIGN = alignof(record);
+
+        inline uint64_t timestamp()
+        {
+#ifdef __x86_64__
+            uint32_t lo, hi;
+            __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+            return ((uint64_t)hi << 32) | lo;
+#else
+            return 0;
+#endif
+        }
+
+        // the type an argument has after default argument promotion, which is also what printf_callback will
+        // va_arg() it as
+        template <typename T, typename U = remove_cv_t<T>>
+        using promoted_t = conditional_t<
+            is_integral_v<U> && (sizeof(U) < sizeof(int)), conditional_t<is_signed_v<U>, int, unsigned int>,
+            conditional_t<is_same_v<U, float>, double, conditional_t<is_array_v<U>, const remove_extent_t<U>*, U>>>;
+
+        template <typename... Ts>
+        struct type_list
+        {
+        };
+
+        template <typename... Vals>
+        void replay(std::binlog::sink_t sink, void* ctx, const char* fmt, ...)
+        {
+            va_list va;
+            va_start(va, fmt);
+            printf_callback([sink, ctx](char ch) { sink(ch, ctx); }, fmt, va);
+            va_end(va);
+        }
+
+        template <typename... Vals>
+        void unpack(type_list<>, std::binlog::sink_t sink, void* ctx, const char* fmt, const char*, Vals... vals)
+        {
+            replay(sink, ctx, fmt, vals...);
+        }
+
+        template <typename T, typename... Rest, typename... Vals>
+        void unpack(type_list<T, Rest...>, std::binlog::sink_t sink, void* ctx, const char* fmt, const char* bytes,
+                    Vals... vals)
+        {
+            T v;
+            __builtin_memcpy(&v, bytes, sizeof(T));
+            unpack(type_list<Rest...>{}, sink, ctx, fmt, bytes + sizeof(T), vals..., v);
+        }
+
+        template <typename... Args>
+        struct codec
+        {
+            static_assert((is_trivially_copyable_v<Args> && ...), "binlog arguments must be trivially copyable");
+
+            static constexpr size_t payload = (sizeof(Args) + ... + 0);
+
+            static void encode(char* out, Args... args)
+            {
+                ((__builtin_memcpy(out, &args, sizeof(Args)), out += sizeof(Args)), ...);
+            }
+
+            static void decode(std::binlog::sink_t sink, void* ctx, const char* fmt, const char* bytes)
+            {
+                unpack(type_list<Args...>{}, sink, ctx, fmt, bytes);
+            }
+        };
+
+        // only used in unevaluated context by BINLOG() to name the codec of a call site
+        template <typename... Args>
+        codec<promoted_t<remove_reference_t<Args>>...> make_codec(Args&&...);
+    } // namespace detail::binlog
+
+    namespace binlog
+    {
+        // A lock-free byte ring holding the records of one cpu
+        // Producers reserve space with a CAS on head, so an interrupt logging on top of a half-written record is
+        // fine. There is exactly one consumer.
+        class ring
+        {
+            char* buf;
+            size_t mask;
+            atomic<size_t> head;
+            atomic<size_t> tail;
+            atomic<size_t> dropped;
+
+            detail::binlog::record* at(size_t pos) const { return (detail::binlog::record*)(buf + (pos & mask)); }
+            uint32_t committed(size_t pos) const { return __atomic_load_n(&at(pos)->size, __ATOMIC_ACQUIRE); }
+
+        public:
+            // n must be a power of two and buf aligned to 8 bytes
+            ring(char* buf, size_t n) : buf(buf), mask(n - 1), head(0), tail(0), dropped(0)
+            {
+                __builtin_memset(buf, 0, n);
+            }
+
+            ring(const ring&) = delete;
+            ring& operator=(const ring&) = delete;
+
+            size_t capacity() const noexcept { return mask + 1; }
+            size_t dropped_count() const noexcept { return dropped.load(memory_order_relaxed); }
+            bool empty() const noexcept { return committed(tail.load(memory_order_relaxed)) == 0; }
+
+            // reserves len bytes and returns where to write them, or nullptr when full
+            char* reserve(size_t len, size_t& pos)
+            {
+                size_t h = head.load(memory_order_relaxed);
+                size_t pad, total;
+                do
+                {
+                    size_t offset = h & mask;
+                    pad = offset + len > capacity() ? capacity() - offset : 0;
+                    total = pad + len;
+                    if (h + total - tail.load(memory_order_acquire) > capacity())
+                    {
+                        dropped.fetch_add(1, memory_order_relaxed);
+                        return nullptr;
+                    }
+                } while (!head.compare_exchange_weak(h, h + total, memory_order_relaxed, memory_order_relaxed));
+
+                if (pad)
+                    __atomic_store_n(&at(h)->size, (uint32_t)pad | detail::binlog::PADDING, __ATOMIC_RELEASE);
+
+                pos = h + pad;
+                return (char*)at(pos);
+            }
+
+            void commit(size_t pos, size_t len) { __atomic_store_n(&at(pos)->size, (uint32_t)len, __ATOMIC_RELEASE); }
+
+            // timestamp of the oldest committed record, skipping over padding; false if there is none
+            bool peek(uint64_t& tsc)
+            {
+                size_t t = tail.load(memory_order_relaxed);
+                uint32_t size = committed(t);
+                if (size & detail::binlog::PADDING)
+                {
+                    __builtin_memset(at(t), 0, size & ~detail::binlog::PADDING);
+                    tail.store(t += size & ~detail::binlog::PADDING, memory_order_release);
+                    size = committed(t);
+                }
+
+                if (size == 0)
+                    return false;
+                tsc = at(t)->tsc;
+                return true;
+            }
+
+            // decodes the oldest record into sink and releases its space, peek() must have returned true
+            void pop(sink_t sink, void* ctx)
+            {
+                size_t t = tail.load(memory_order_relaxed);
+                auto* rec = at(t);
+                uint32_t size = rec->size;
+                rec->id->decode(sink, ctx, rec->id->fmt, (const char*)(rec + 1));
+
+                // the whole record is cleared, not just the header: a later record may start at what is now an
+                // argument byte, and the consumer must read zero there until that record is committed
+                __builtin_memset(rec, 0, size);
+                tail.store(t + size, memory_order_release);
+            }
+        };
+
+        // storage for a ring, N must be a power of two
+        template <size_t N>
+        class static_ring : public ring
+        {
+            static_assert(N && (N & (N - 1)) == 0, "binlog ring size must be a power of two");
+            alignas(detail::binlog::ALIGN) char storage[N];
+
+        public:
+            static_ring() : ring(storage, N) {}
+        };
+    } // namespace binlog
+
+    namespace detail::binlog
+    {
+        inline std::binlog::ring* rings[std::binlog::MAX_CPUS] = {};
+    }
+
+    namespace binlog
+    {
+        // registers r as the ring for cpu, must happen before that cpu logs; cpu must be below MAX_CPUS
+        inline void attach(size_t cpu, ring& r)
+        {
+            if (cpu >= MAX_CPUS)
+                detail::errors::__stdexcept_out_of_range();
+            detail::binlog::rings[cpu] = &r;
+        }
+
+        template <typename... Args>
+        [[gnu::always_inline]] inline bool write(const site* s, Args... args)
+        {
+            using codec = detail::binlog::codec<detail::binlog::promoted_t<Args>...>;
+            constexpr size_t len = (sizeof(detail::binlog::record) + codec::payload + detail::binlog::ALIGN - 1) &
+                                   ~(detail::binlog::ALIGN - 1);
+
+            // a cpu without a ring, including one past MAX_CPUS, drops its records
+            size_t cpu = detail::cpu_id();
+            if (cpu >= MAX_CPUS)
+                return false;
+            ring* r = detail::binlog::rings[cpu];
+            if (!r)
+                return false;
+
+            size_t pos;
+            char* out = r->reserve(len, pos);
+            if (!out)
+                return false;
+
+            auto* rec = (detail::binlog::record*)out;
+            rec->id = s;
+            rec->tsc = detail::binlog::timestamp();
+            codec::encode(out + sizeof(detail::binlog::record), detail::binlog::promoted_t<Args>(args)...);
+            r->commit(pos, len);
+            return true;
+        }
+
+        // formats every pending record of every cpu into printer, oldest first. returns the amount of records
+        template <typename P>
+        size_t drain(P printer)
+        {
+            sink_t sink = [](char ch, void* ctx) { (*(P*)ctx)(ch); };
+            size_t n = 0;
+
+            while (true)
+            {
+                ring* next = nullptr;
+                uint64_t oldest = 0;
+                for (auto* r : detail::binlog::rings)
+                {
+                    uint64_t tsc;
+                    if (r && r->peek(tsc) && (!next || tsc < oldest))
+                    {
+                        next = r;
+                        oldest = tsc;
+                    }
+                }
+
+                if (!next)
+                    return n;
+
+                next->pop(sink, &printer);
+                n++;
+            }
+        }
+    } // namespace binlog
+} // namespace std
+
+#endif
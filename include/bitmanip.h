@@ -41,6 +41,30 @@ namespace std
         v &= ~(((1ULL << (uint64_t)(end - start + 1)) - 1) << start);
         v |= (((1ULL << (uint64_t)(end - start + 1)) - 1) << start) & to_set;
     }
+
+    namespace detail
+    {
+        // 64 bit scans that are defined for 0, which has 64 zeros either way; they compile to tzcnt/lzcnt/popcnt
+        // where the target has them. Kept out of std, where the <bit> templates of the same names count within the
+        // width of their argument's type
+        constexpr inline int countr_zero(uint64_t v) { return v ? __builtin_ctzll(v) : 64; }
+        constexpr inline int countl_zero(uint64_t v) { return v ? __builtin_clzll(v) : 64; }
+        constexpr inline int popcount(uint64_t v) { return __builtin_popcountll(v); }
+    } // namespace detail
+
+    // the lowest index at which v has k clear bits in a row, for 1 <= k <= 64; 64 if there is no such run.
+    // bit i of m is set when bits i ... i + run - 1 of v are all clear, and each step doubles run
+    constexpr inline int find_zero_run(uint64_t v, uint8_t k)
+    {
+        uint64_t m = ~v;
+        for (unsigned run = 1; run < k && m;)
+        {
+            unsigned s = run < k - run ? run : k - run;
+            m &= m >> s;
+            run += s;
+        }
+        return detail::countr_zero(m);
+    }
 } // namespace std
 
 #endif
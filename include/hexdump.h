@@ -0,0 +1,120 @@
+#ifndef __NOSTDLIB_HEXDUMP_H__
+#define __NOSTDLIB_HEXDUMP_H__
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+
+namespace std
+{
+    namespace detail::hexdump
+    {
+        inline constexpr size_t BYTES_PER_LINE = 16;
+
+        // turns 4 bytes into 8 hex digits, first byte in the lowest bits of both input and output
+        // every byte is spread into its own 16 bit lane, the nibbles are swapped into "high nibble first" order and
+        // then all 8 digits are converted at once: '0' + n, plus the gap to 'a' (or 'A') for n > 9
+        inline uint64_t nibbles_to_ascii(uint32_t v, bool upper)
+        {
+            uint64_t x = v;
+            x = (x | (x << 16)) & 0x0000ffff0000ffff;
+            x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+            x = ((x >> 4) & 0x000f000f000f000f) | ((x & 0x000f000f000f000f) << 8);
+
+            uint64_t over9 = ((x + 0x0606060606060606) >> 4) & 0x0101010101010101;
+            return x + 0x3030303030303030 + over9 * (upper ? 'A' - '9' - 1 : 'a' - '9' - 1);
+        }
+
+        inline uint32_t load4(const unsigned char* p)
+        {
+            uint32_t v;
+            __builtin_memcpy(&v, p, 4);
+            return v;
+        }
+    } // namespace detail::hexdump
+
+    // writes 2 * n hex digits of data to out (without a terminator), returns the end of the output
+    inline char* to_hex(char* out, const void* data, size_t n, bool upper = false)
+    {
+        auto* p = (const unsigned char*)data;
+
+        for (; n >= 4; n -= 4, p += 4, out += 8)
+        {
+            uint64_t digits = detail::hexdump::nibbles_to_ascii(detail::hexdump::load4(p), upper);
+            __builtin_memcpy(out, &digits, 8);
+        }
+
+        const char* int2char = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+        for (; n; n--, p++)
+        {
+            *out++ = int2char[*p >> 4];
+            *out++ = int2char[*p & 0xf];
+        }
+
+        return out;
+    }
+
+    // prints n bytes of data to printer as
+    //     <address>: xx xx xx xx xx xx xx xx  xx xx xx xx xx xx xx xx   |................|
+    // where the address column starts at base. every line is assembled in a local buffer and then
+    // handed to printer one character at a time, like printf_callback does
+    template <typename P>
+    void hexdump(P printer, const void* data, size_t n, uintptr_t base)
+    {
+        constexpr size_t ADDRESS = sizeof(uintptr_t) * 2;
+        constexpr size_t LINE = detail::hexdump::BYTES_PER_LINE;
+        char line[ADDRESS + 2 + LINE * 3 + 1 + 2 + LINE + 2];
+        char digits[LINE * 2];
+
+        auto* p = (const unsigned char*)data;
+        for (size_t offset = 0; offset < n; offset += LINE)
+        {
+            size_t count = n - offset < LINE ? n - offset : LINE;
+            char* out = line;
+
+            uintptr_t address = base + offset;
+            for (size_t i = ADDRESS; i--;)
+                *out++ = "0123456789abcdef"[(address >> (i * 4)) & 0xf];
+            *out++ = ':';
+            *out++ = ' ';
+
+            to_hex(digits, p + offset, count);
+            for (size_t i = 0; i < LINE; i++)
+            {
+                if (i < count)
+                {
+                    *out++ = digits[i * 2];
+                    *out++ = digits[i * 2 + 1];
+                }
+                else
+                {
+                    *out++ = ' ';
+                    *out++ = ' ';
+                }
+                *out++ = ' ';
+                if (i == LINE / 2 - 1)
+                    *out++ = ' ';
+            }
+
+            *out++ = ' ';
+            *out++ = '|';
+            for (size_t i = 0; i < count; i++)
+            {
+                char ch = p[offset + i];
+                *out++ = isgraph(ch) || ch == ' ' ? ch : '.';
+            }
+            *out++ = '|';
+            *out++ = '\n';
+
+            for (char* c = line; c != out; c++)
+                printer(*c);
+        }
+    }
+
+    template <typename P>
+    void hexdump(P printer, const void* data, size_t n)
+    {
+        hexdump(printer, data, n, (uintptr_t)data);
+    }
+} // namespace std
+
+#endif
@@ -37,28 +37,78 @@ namespace std
             PTRDIFF,
         };
 
+        inline constexpr uint64_t pow10[] = {1ULL,
+                                             10ULL,
+                                             100ULL,
+                                             1000ULL,
+                                             10000ULL,
+                                             100000ULL,
+                                             1000000ULL,
+                                             10000000ULL,
+                                             100000000ULL,
+                                             1000000000ULL,
+                                             10000000000ULL,
+                                             100000000000ULL,
+                                             1000000000000ULL,
+                                             10000000000000ULL,
+                                             100000000000000ULL,
+                                             1000000000000000ULL,
+                                             10000000000000000ULL,
+                                             100000000000000000ULL,
+                                             1000000000000000000ULL,
+                                             10000000000000000000ULL};
+
         template <typename T>
-        constexpr size_t floor_log(unsigned base, T val)
+        constexpr uint64_t magnitude(T val)
         {
-            if (val < 0)
-                val = -val;
-            size_t ret = 0;
-            while ((val /= base))
+            return val < 0 ? 0 - (uint64_t)val : (uint64_t)val;
+        }
+
+        // amount of digits of v, from its bit length instead of dividing it down
+        constexpr size_t digit_count(unsigned base, uint64_t v)
+        {
+            if (v == 0)
+                return 1;
+
+            size_t bits = 64 - __builtin_clzll(v);
+            switch (base)
+            {
+            case 16:
+                return (bits + 3) / 4;
+            case 8:
+                return (bits + 2) / 3;
+            case 10: {
+                // 1233 / 4096 ~= log10(2), which is either exact or one short
+                size_t t = (bits * 1233) >> 12;
+                return t + (v >= pow10[t]);
+            }
+            }
+
+            size_t ret = 1;
+            while ((v /= base))
                 ret++;
             return ret;
         }
 
-        // guesses the printed length of an integer
         template <typename T>
-        constexpr size_t guess_len(unsigned b, T val, unsigned flag, unsigned precision)
+        constexpr size_t floor_log(unsigned base, T val)
+        {
+            return digit_count(base, magnitude(val)) - 1;
+        }
+
+        // guesses the printed length of an integer. is_signed is whether the conversion is a signed one (%d, %i),
+        // which decides whether + and space print a sign; T alone does not say, since %zd reads a size_t
+        template <typename T>
+        constexpr size_t guess_len(unsigned b, T val, unsigned flag, unsigned precision, bool is_signed)
         {
             size_t ret = max(floor_log(b, val) + 1, (size_t)precision);
 
-            if constexpr (is_signed_v<T>)
+            if (is_signed)
             {
-                if (val < 0)
-                    ret++;
-                else if (flag & PLUS || flag & SPACE)
+                bool negative = false;
+                if constexpr (is_signed_v<T>)
+                    negative = val < 0;
+                if (negative || flag & PLUS || flag & SPACE)
                     ret++;
             }
 
@@ -73,6 +123,38 @@ namespace std
             return precision > len ? precision - len : 0;
         }
 
+        // a printer that discards everything, printf_callback only measures the output when given one
+        struct null_sink
+        {
+            constexpr void operator()(char) const noexcept {}
+        };
+
+        // wraps the user printer and counts the characters that went through it
+        template <typename C>
+        struct output
+        {
+            static constexpr bool dry = is_same_v<C, null_sink>;
+
+            C& printer;
+            size_t count = 0;
+
+            void operator()(char ch)
+            {
+                if constexpr (!dry)
+                    printer(ch);
+                count++;
+            }
+
+            void pad(char ch, size_t n)
+            {
+                if constexpr (dry)
+                    count += n;
+                else
+                    for (size_t i = 0; i < n; i++)
+                        (*this)(ch);
+            }
+        };
+
         struct printf_command
         {
             unsigned precision = 0;
@@ -82,9 +164,9 @@ namespace std
         };
 
         template <typename P>
-        void handle_special(va_list fmtargs, const char*& format, printf_command& cmd, P print)
+        void handle_special(va_list fmtargs, const char*& format, printf_command& cmd, P& print)
         {
-            size_t width_len;
+            size_t width_len, content_len;
             const char* str;
             char buf[sizeof(void*) * 2] = {};
             std::memset(buf, '0', sizeof(buf));
@@ -92,21 +174,30 @@ namespace std
             switch (*format)
             {
             case 'c':
-                width_len = 1;
+                content_len = 1;
                 break;
             case 's':
-                width_len = strlen(str = va_arg(fmtargs, const char*));
+                content_len = strlen(str = va_arg(fmtargs, const char*));
                 break;
             case 'p':
-                width_len = sizeof(void*) * 2;
+                content_len = sizeof(void*) * 2;
                 break;
             }
 
-            width_len = cmd.width > width_len ? cmd.width - width_len : 0;
+            width_len = cmd.width > content_len ? cmd.width - content_len : 0;
+
+            if constexpr (P::dry)
+            {
+                if (*format == 'c')
+                    va_arg(fmtargs, int);
+                else if (*format == 'p')
+                    va_arg(fmtargs, void*);
+                print.pad(cmd.padchar, width_len + content_len);
+                return;
+            }
 
             if (!(cmd.flags & LEFT))
-                for (size_t i = 0; i < width_len; i++)
-                    print(cmd.padchar);
+                print.pad(cmd.padchar, width_len);
 
             switch (*format)
             {
@@ -131,36 +222,33 @@ namespace std
             }
 
             if (cmd.flags & LEFT)
-                for (size_t i = 0; i < width_len; i++)
-                    print(cmd.padchar);
+                print.pad(cmd.padchar, width_len);
         }
 
         // prints an properly formatted integer
         template <typename s, typename u, typename p, typename P>
-        void format_int(va_list fmtargs, const printf_command& cmd, const char* format, size_t pc, P print)
+        void format_int(va_list fmtargs, const printf_command& cmd, const char* format, P& print)
         {
-            char tmp[16] = {0};
+            // 64 bit octal is 22 digits
+            char tmp[24] = {0};
             const char* int2char = (isupper(*format) || (cmd.flags & UPPERCASE)) ? "0123456789ABCDEF" : "0123456789abcdef";
+            size_t content_len = 0;
             size_t width_len = 0;
             size_t precision_len = 0;
             bool sign = false;
             bool is_signed = false;
 
+            // when only measuring the output the digits are never generated, their count comes from guess_len
             auto itoa = [&](unsigned radix, auto val) {
-                if (val == 0)
-                {
-                    tmp[0] = '0';
+                if constexpr (P::dry)
                     return;
-                }
-                if constexpr (is_signed_v<decltype(val)>)
-                    if (val < 0)
-                        val = -val;
+                uint64_t v = magnitude(val);
                 size_t index = 0;
-                while (val)
+                do
                 {
-                    tmp[index++] = int2char[val % radix];
-                    val /= radix;
-                }
+                    tmp[index++] = int2char[v % radix];
+                    v /= radix;
+                } while (v);
             };
 
             using _s = std::conditional_t<(sizeof(s) > sizeof(int)), s, int>;
@@ -175,21 +263,21 @@ namespace std
                 if (val < 0)
                     sign = true;
                 is_signed = true;
-                width_len = guess_len(10, val, cmd.flags, cmd.precision);
+                content_len = guess_len(10, val, cmd.flags, cmd.precision, is_signed);
                 precision_len = precision_pad_chars(10, val, cmd.precision);
                 break;
             }
             case 'u': {
                 u val = va_arg(fmtargs, _u);
                 itoa(10, val);
-                width_len = guess_len(10, val, cmd.flags, cmd.precision);
+                content_len = guess_len(10, val, cmd.flags, cmd.precision, false);
                 precision_len = precision_pad_chars(10, val, cmd.precision);
                 break;
             }
             case 'o': {
                 u val = va_arg(fmtargs, _u);
                 itoa(8, val);
-                width_len = guess_len(8, val, cmd.flags, cmd.precision);
+                content_len = guess_len(8, val, cmd.flags, cmd.precision, false);
                 precision_len = precision_pad_chars(8, val, cmd.precision);
                 break;
             }
@@ -197,22 +285,27 @@ namespace std
             case 'X': {
                 u val = va_arg(fmtargs, _u);
                 itoa(16, val);
-                width_len = guess_len(16, val, cmd.flags, cmd.precision);
+                content_len = guess_len(16, val, cmd.flags, cmd.precision, false);
                 precision_len = precision_pad_chars(16, val, cmd.precision);
                 break;
             }
             case 'n':
-                *va_arg(fmtargs, p) = pc;
+                *va_arg(fmtargs, p) = print.count;
                 return;
             default:
                 detail::errors::__printf_undefined_specifier_for_length();
             }
 
-            width_len = cmd.width > width_len ? cmd.width - width_len : 0;
+            width_len = cmd.width > content_len ? cmd.width - content_len : 0;
+
+            if constexpr (P::dry)
+            {
+                print.pad(cmd.padchar, width_len + content_len);
+                return;
+            }
 
             if (!(cmd.flags & LEFT))
-                for (size_t i = 0; i < width_len; i++)
-                    print(cmd.padchar);
+                print.pad(cmd.padchar, width_len);
 
             if (sign)
                 print('-');
@@ -224,18 +317,16 @@ namespace std
                     print('+');
             }
 
-            for (size_t i = 0; i < precision_len; i++)
-                print('0');
+            print.pad('0', precision_len);
 
-            for (int i = 15; i >= 0; i--)
+            for (int i = sizeof(tmp) - 1; i >= 0; i--)
             {
                 if (tmp[i])
                     print(tmp[i]);
             }
 
             if (cmd.flags & LEFT)
-                for (size_t i = 0; i < width_len; i++)
-                    print(cmd.padchar);
+                print.pad(cmd.padchar, width_len);
         }
 
     } // namespace detail::printf
@@ -244,7 +335,7 @@ namespace std
     int printf_callback(C printer, const char* format, va_list fmtargs)
     {
         using namespace detail::printf;
-        size_t printed_characters = 0;
+        output<C> print{printer};
 
         auto atoi_inc_str = [&]() mutable {
             unsigned int i = 0;
@@ -253,11 +344,6 @@ namespace std
             return i;
         };
 
-        auto print = [&](char ch) mutable {
-            printer(ch);
-            printed_characters++;
-        };
-
         while (*format)
         {
             printf_command cmd;
@@ -374,68 +460,86 @@ namespace std
             switch (len)
             {
             case NORMAL:
-                format_int<int, unsigned, int*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<int, unsigned, int*>(fmtargs, cmd, format, print);
                 break;
             case CHAR:
-                format_int<signed char, unsigned char, char*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<signed char, unsigned char, char*>(fmtargs, cmd, format, print);
                 break;
             case SHORT:
-                format_int<short, unsigned short, short*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<short, unsigned short, short*>(fmtargs, cmd, format, print);
                 break;
             case LONG:
-                format_int<long, unsigned long, long*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<long, unsigned long, long*>(fmtargs, cmd, format, print);
                 break;
             case LLONG:
-                format_int<long long, unsigned long long, long long*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<long long, unsigned long long, long long*>(fmtargs, cmd, format, print);
                 break;
             case INTMAX:
-                format_int<intmax_t, uintmax_t, intmax_t*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<intmax_t, uintmax_t, intmax_t*>(fmtargs, cmd, format, print);
                 break;
             case PTRDIFF:
-                format_int<ptrdiff_t, ptrdiff_t, ptrdiff_t*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<ptrdiff_t, size_t, ptrdiff_t*>(fmtargs, cmd, format, print);
                 break;
             case SIZE:
-                format_int<size_t, size_t, size_t*>(fmtargs, cmd, format, printed_characters, print);
+                format_int<size_t, size_t, size_t*>(fmtargs, cmd, format, print);
                 break;
             }
 
             format++;
         }
         printer('\0');
-        return printed_characters;
+        return print.count;
     }
 
     inline int printf(const char* format, ...)
     {
         va_list va;
         va_start(va, format);
-        return printf_callback(detail::putc, format, va);
+        int ret = printf_callback(detail::putc, format, va);
         va_end(va);
+        return ret;
     }
 
     inline int sprintf(char* buffer, const char* format, ...)
     {
         va_list va;
         va_start(va, format);
-        return printf_callback([&, buffer](char ch) mutable { *buffer++ = ch; }, format, va);
+        int ret = printf_callback([&, buffer](char ch) mutable { *buffer++ = ch; }, format, va);
         va_end(va);
+        return ret;
     }
 
-    inline int snprintf(char* buffer, size_t count, const char* format, ...)
+    // writes at most count - 1 characters and a terminating '\0', and returns the length the whole output would
+    // have had. with count == 0 nothing is written and the output is only measured, without generating any digits:
+    //     int n = snprintf(nullptr, 0, fmt, ...);
+    inline int vsnprintf(char* buffer, size_t count, const char* format, va_list va)
     {
-        va_list va;
-        va_start(va, format);
+        if (count == 0)
+            return printf_callback(detail::printf::null_sink{}, format, va);
 
         return printf_callback(
             [&, buffer](char ch) mutable {
-                if (count)
+                if (count > 1)
                 {
                     *buffer++ = ch;
                     count--;
                 }
+                else if (count == 1)
+                {
+                    *buffer = '\0';
+                    count--;
+                }
             },
             format, va);
+    }
+
+    inline int snprintf(char* buffer, size_t count, const char* format, ...)
+    {
+        va_list va;
+        va_start(va, format);
+        int ret = vsnprintf(buffer, count, format, va);
         va_end(va);
+        return ret;
     }
 } // namespace std
 
@@ -0,0 +1,20 @@
+#include <atomic>
+#include <cstdint>
+
+namespace std::detail
+{
+    namespace
+    {
+        constexpr size_t bucket_bits = 8;
+
+        atomic_wait_bucket buckets[1 << bucket_bits];
+    } // namespace
+
+    // Fibonacci hashing of the cache line; objects on the same line share a bucket, which costs at most a spurious
+    // wakeup
+    atomic_wait_bucket& atomic_wait_bucket_of(const volatile void* addr) noexcept
+    {
+        uint64_t line = (uintptr_t)addr / hardware_constructive_interference_size;
+        return buckets[(line * 0x9e3779b97f4a7c15) >> (64 - bucket_bits)];
+    }
+} // namespace std::detail
@@ -0,0 +1,221 @@
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+namespace std
+{
+    namespace detail
+    {
+        constexpr uint64_t ascii_zero = 0x3030303030303030;
+
+        inline uint64_t load8(const char* p)
+        {
+            uint64_t v;
+            __builtin_memcpy(&v, p, 8);
+            return v;
+        }
+
+        // amount of leading ascii digits in the 8 bytes of v, first character in the lowest byte
+        // a byte is a digit iff its high nibble is 3 both before and after adding 6. The add may carry out of
+        // bytes >= 0xfa, but those are non-digits and carries only travel towards later characters
+        inline unsigned swar_digit_count(uint64_t v)
+        {
+            uint64_t bad = ((v & 0xf0f0f0f0f0f0f0f0) ^ ascii_zero) |
+                           (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) ^ ascii_zero);
+            return bad ? __builtin_ctzll(bad) / 8 : 8;
+        }
+
+        // converts 8 decimal digits (already minus '0') into their value in 3 multiplies
+        inline uint64_t swar_convert8(uint64_t v)
+        {
+            v = (v * 10) + (v >> 8);
+            return (((v & 0x000000ff000000ff) * (100 + (1000000ULL << 32))) +
+                    (((v >> 16) & 0x000000ff000000ff) * (1 + (10000ULL << 32)))) >>
+                   32;
+        }
+
+        constexpr uint64_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+        inline unsigned digit_value(char c)
+        {
+            if (isdigit(c))
+                return c - '0';
+            if (isupper(c))
+                return c - 'A' + 10;
+            if (islower(c))
+                return c - 'a' + 10;
+            return 36;
+        }
+
+        // base 10 digits, 8 at a time. NUL terminated input (end == nullptr) is only known to be readable up to its
+        // terminator, so its digits are found a byte at a time first and only those are loaded 8 at a time
+        inline const char* parse_dec(const char* p, const char* end, uint64_t& value, bool& overflow)
+        {
+            if (!end)
+            {
+                end = p;
+                while (isdigit(*end))
+                    end++;
+            }
+
+            uint64_t v = 0;
+            while (end - p >= 8)
+            {
+                uint64_t chunk = load8(p);
+                unsigned n = swar_digit_count(chunk);
+                if (n == 0)
+                    break;
+
+                // move the digits to the top so the non-digit bytes become leading zeroes
+                chunk = (chunk - ascii_zero) << (8 * (8 - n));
+                overflow |= __builtin_mul_overflow(v, pow10[n], &v);
+                overflow |= __builtin_add_overflow(v, swar_convert8(chunk), &v);
+                p += n;
+
+                if (n != 8)
+                {
+                    value = v;
+                    return p;
+                }
+            }
+
+            for (; p != end && isdigit(*p); p++)
+            {
+                overflow |= __builtin_mul_overflow(v, 10, &v);
+                overflow |= __builtin_add_overflow(v, (uint64_t)(*p - '0'), &v);
+            }
+
+            value = v;
+            return p;
+        }
+
+        inline const char* parse_base(const char* p, const char* end, unsigned base, uint64_t& value, bool& overflow)
+        {
+            if (base == 10)
+                return parse_dec(p, end, value, overflow);
+
+            uint64_t v = 0;
+            for (unsigned d; (!end || p != end) && (d = digit_value(*p)) < base; p++)
+            {
+                overflow |= __builtin_mul_overflow(v, (uint64_t)base, &v);
+                overflow |= __builtin_add_overflow(v, (uint64_t)d, &v);
+            }
+
+            value = v;
+            return p;
+        }
+
+        // consumes a 0x prefix for base 0 or 16, and picks octal for a leading 0 under base 0
+        // the x is only taken if a hex digit follows it, so "0x" parses as 0 with str_end at the x
+        inline unsigned parse_prefix(const char*& p, const char* end, int base)
+        {
+            if ((base == 0 || base == 16) && (!end || end - p >= 3) && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') &&
+                isxdigit(p[2]))
+            {
+                p += 2;
+                return 16;
+            }
+
+            if (base == 0)
+                return ((!end || p != end) && *p == '0') ? 8 : 10;
+
+            return base;
+        }
+
+        // the common part of strto*: whitespace, sign, prefix and the magnitude
+        inline const char* strto_common(const char* str, int base, uint64_t& magnitude, bool& neg, bool& overflow)
+        {
+            const char* p = str;
+            while (isspace(*p))
+                p++;
+
+            neg = *p == '-';
+            if (*p == '-' || *p == '+')
+                p++;
+
+            if (base < 0 || base == 1 || base > 36)
+                return str;
+
+            unsigned b = parse_prefix(p, nullptr, base);
+            const char* digits = p;
+            p = parse_base(p, nullptr, b, magnitude, overflow);
+            return p == digits ? str : p;
+        }
+
+        template <typename T>
+        T strto_unsigned(const char* str, char** str_end, int base)
+        {
+            uint64_t magnitude = 0;
+            bool neg, overflow = false;
+            const char* p = strto_common(str, base, magnitude, neg, overflow);
+            if (str_end)
+                *str_end = (char*)p;
+
+            if (overflow || magnitude > (T)-1)
+                return (T)-1;
+            return neg ? (T)-magnitude : (T)magnitude;
+        }
+
+        template <typename T, typename U>
+        T strto_signed(const char* str, char** str_end, int base)
+        {
+            constexpr U max = (U)-1 >> 1;
+
+            uint64_t magnitude = 0;
+            bool neg, overflow = false;
+            const char* p = strto_common(str, base, magnitude, neg, overflow);
+            if (str_end)
+                *str_end = (char*)p;
+
+            if (neg)
+                return (overflow || magnitude > max + 1) ? (T)(max + 1) : (T)(0 - (U)magnitude);
+            return (overflow || magnitude > max) ? (T)max : (T)magnitude;
+        }
+    } // namespace detail
+
+    long strtol(const char* __restrict str, char** __restrict str_end, int base)
+    {
+        return detail::strto_signed<long, unsigned long>(str, str_end, base);
+    }
+
+    long long strtoll(const char* __restrict str, char** __restrict str_end, int base)
+    {
+        return detail::strto_signed<long long, unsigned long long>(str, str_end, base);
+    }
+
+    unsigned long strtoul(const char* __restrict str, char** __restrict str_end, int base)
+    {
+        return detail::strto_unsigned<unsigned long>(str, str_end, base);
+    }
+
+    unsigned long long strtoull(const char* __restrict str, char** __restrict str_end, int base)
+    {
+        return detail::strto_unsigned<unsigned long long>(str, str_end, base);
+    }
+
+    int atoi(const char* str) { return (int)strtol(str, nullptr, 10); }
+    long atol(const char* str) { return strtol(str, nullptr, 10); }
+    long long atoll(const char* str) { return strtoll(str, nullptr, 10); }
+
+    parse_result parse_uint(const char* first, const char* last, uint64_t& value, int base)
+    {
+        if (base < 0 || base == 1 || base > 36)
+            return {first, parse_status::invalid};
+
+        const char* p = first;
+        unsigned b = detail::parse_prefix(p, last, base);
+        const char* digits = p;
+
+        bool overflow = false;
+        uint64_t v;
+        p = detail::parse_base(p, last, b, v, overflow);
+
+        if (p == digits)
+            return {first, parse_status::invalid};
+        if (overflow)
+            return {p, parse_status::overflow};
+
+        value = v;
+        return {p, parse_status::ok};
+    }
+} // namespace std
@@ -1,10 +1,25 @@
 #include "../bits/user_implement.h"
 #include "../bits/utils.h"
+#include <cstdint>
 #include <cstring>
 #include <new>
 
 namespace std
 {
+#ifdef __SSE2__
+    namespace
+    {
+        // 16 bytes at a time: a compare sets every matching byte to 0xff and pmovmskb packs those into a bit mask,
+        // the same way the swiss table probes its control bytes
+        using v16 = char __attribute__((vector_size(16)));
+        using v16u = char __attribute__((vector_size(16), aligned(1), may_alias));
+
+        inline v16 load16(const void* p) { return *(const v16u*)p; }
+        inline uint32_t movemask(v16 v) { return (uint16_t)__builtin_ia32_pmovmskb128(v); }
+        inline v16 splat(char c) { return v16{} + c; }
+    } // namespace
+#endif
+
     char* strcpy(char* __restrict dest, const char* __restrict src) { return (char*)memcpy(dest, src, strlen(src) + 1); }
 
     char* strncpy(char* __restrict dest, const char* __restrict src, size_t n)
@@ -290,15 +305,102 @@ namespace std
         return nullptr;
     }
 
-    char* strstr(char* s, const char* target);
-    const char* strstr(const char* s, const char* target);
+    char* strstr(char* s, const char* target) { return (char*)strstr((const char*)s, target); }
+
+    const char* strstr(const char* s, const char* target)
+    {
+        return (const char*)memmem(s, strlen(s), target, strlen(target));
+    }
 
     char* strtok(char* __restrict s, const char* __restrict delim);
 
-    void* memchr(void* s, int c, size_t n);
-    const void* memchr(const void* s, int c, size_t n);
+    void* memchr(void* s, int c, size_t n) { return (void*)memchr((const void*)s, c, n); }
+
+    const void* memchr(const void* s, int c, size_t n)
+    {
+        const unsigned char* p = (const unsigned char*)s;
+#ifdef __SSE2__
+        const v16 needle = splat((char)c);
+        for (; n >= 16; p += 16, n -= 16)
+            if (uint32_t m = movemask((v16)(load16(p) == needle)))
+                return p + __builtin_ctz(m);
+#endif
+        for (; n; p++, n--)
+            if (*p == (unsigned char)c)
+                return p;
+        return nullptr;
+    }
+
+    const void* memrchr(const void* s, int c, size_t n)
+    {
+        const unsigned char* p = (const unsigned char*)s;
+#ifdef __SSE2__
+        const v16 needle = splat((char)c);
+        for (; n >= 16; n -= 16)
+            if (uint32_t m = movemask((v16)(load16(p + n - 16) == needle)))
+                return p + n - 16 + (31 - __builtin_clz(m));
+#endif
+        while (n--)
+            if (p[n] == (unsigned char)c)
+                return p + n;
+        return nullptr;
+    }
+
+    int memcmp(const void* s1, const void* s2, size_t n)
+    {
+        const unsigned char* a = (const unsigned char*)s1;
+        const unsigned char* b = (const unsigned char*)s2;
+#ifdef __SSE2__
+        for (; n >= 16; a += 16, b += 16, n -= 16)
+        {
+            if (uint32_t m = movemask((v16)(load16(a) == load16(b))) ^ 0xffff)
+            {
+                int i = __builtin_ctz(m);
+                return a[i] - b[i];
+            }
+        }
+#endif
+        for (; n; a++, b++, n--)
+            if (*a != *b)
+                return *a - *b;
+        return 0;
+    }
+
+    // looks for the needle's first and last bytes at 16 candidate positions at once, and only compares the whole
+    // needle where both match, which skips most false starts on text
+    const void* memmem(const void* haystack, size_t n, const void* needle, size_t m)
+    {
+        const char* h = (const char*)haystack;
+        const char* nd = (const char*)needle;
+
+        if (m == 0)
+            return h;
+        if (m > n)
+            return nullptr;
+        if (m == 1)
+            return memchr(h, nd[0], n);
+
+        const size_t last = n - m;
+        size_t i = 0;
+#ifdef __SSE2__
+        const v16 first = splat(nd[0]), tail = splat(nd[m - 1]);
+        for (; i + 15 <= last; i += 16)
+        {
+            uint32_t mask = movemask((v16)(load16(h + i) == first) & (v16)(load16(h + i + m - 1) == tail));
+            for (; mask; mask &= mask - 1)
+            {
+                size_t at = i + __builtin_ctz(mask);
+                if (!memcmp(h + at + 1, nd + 1, m - 2))
+                    return h + at;
+            }
+        }
+#endif
+        for (; i <= last; i++)
+            if (h[i] == nd[0] && h[i + m - 1] == nd[m - 1] && !memcmp(h + i + 1, nd + 1, m - 2))
+                return h + i;
+        return nullptr;
+    }
 
-    int memcmp(const void* s1, const void* s2, size_t n);
     void* memset(void* s, int c, size_t n)
     {
         c = c & 0xff;
@@ -307,18 +409,18 @@ namespace std
         if constexpr (sizeof(size_t) == 8)
             v |= ((size_t)c << 32) | ((size_t)c << 40) | ((size_t)c << 48) | ((size_t)c << 56);
 
-        while (((size_t)b) % alignof(size_t) != 0 && n-- != 0)
+        for (; n != 0 && (size_t)b % alignof(size_t) != 0; n--)
             *b++ = c;
 
         if (n == 0)
             return s;
 
         size_t* sp = (size_t*)b;
-        for (size_t i = 0; i < n / 8; i++)
+        for (size_t i = 0; i < n / sizeof(size_t); i++)
             sp[i] = v;
 
-        b = (char*)sp;
-        for (size_t i = 0; i < n % 8; i++)
+        b = (char*)(sp + n / sizeof(size_t));
+        for (size_t i = 0; i < n % sizeof(size_t); i++)
             b[i] = c;
 
         return s;
@@ -331,23 +433,21 @@ namespace std
         char* d = (char*)dest;
         const char* s = (const char*)src;
 
-        while (((size_t)d % alignof(size_t) != 0) && ((size_t)s % alignof(size_t) != 0) && n-- != 0)
+        for (; n != 0 && (size_t)d % alignof(size_t) != 0; n--)
             *d++ = *s++;
 
         if (n == 0)
             return dest;
 
+        // dest is aligned now, but src need not be
         size_t* sd = (size_t*)d;
-        const size_t* ss = (size_t*)s;
-
         size_t i = n / sizeof(size_t);
-        while (i--)
-            *sd++ = *ss++;
+        for (; i--; sd++, s += sizeof(size_t))
+            __builtin_memcpy(sd, s, sizeof(size_t));
 
         n %= sizeof(size_t);
 
         d = (char*)sd;
-        s = (const char*)ss;
         while (n--)
             *d++ = *s++;
 
@@ -356,5 +456,39 @@ namespace std
     }
 
     void* memccpy(void* __restrict dest, const void* __restrict src, int c, size_t n);
-    void* memmove(void* dest, const void* src, size_t n);
+    void* memmove(void* dest, const void* src, size_t n)
+    {
+        char* d = (char*)dest;
+        const char* s = (const char*)src;
+
+        if (d + n <= s || s + n <= d)
+            return memcpy(dest, src, n);
+
+        // overlapping: copy forwards when dest is below src and backwards otherwise, so nothing is overwritten before
+        // it is read
+        if (d < s)
+        {
+            size_t i = 0;
+            for (; i + sizeof(size_t) <= n; i += sizeof(size_t))
+            {
+                size_t w;
+                __builtin_memcpy(&w, s + i, sizeof(w));
+                __builtin_memcpy(d + i, &w, sizeof(w));
+            }
+            for (; i < n; i++)
+                d[i] = s[i];
+            return dest;
+        }
+
+        while (n >= sizeof(size_t))
+        {
+            n -= sizeof(size_t);
+            size_t w;
+            __builtin_memcpy(&w, s + n, sizeof(w));
+            __builtin_memcpy(d + n, &w, sizeof(w));
+        }
+        while (n--)
+            d[n] = s[n];
+        return dest;
+    }
 } // namespace std
@@ -0,0 +1,72 @@
+#include "../bits/fork_join.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace std::detail
+{
+    namespace
+    {
+        // a pool thread parks on its own go word, which the caller bumps to hand it the current job
+        struct alignas(destructive_line_size) pool_thread
+        {
+            atomic<uint32_t> go{0};
+        };
+
+        struct pool
+        {
+            atomic<bool> busy{false};
+            // how many threads have been started; only changed by the caller holding busy
+            size_t started = 0;
+            void (*job)(void*) noexcept = nullptr;
+            void* ctx = nullptr;
+            // the pool threads still running the current job, which the caller waits on
+            alignas(destructive_line_size) atomic<uint32_t> running{0};
+            pool_thread threads[max_fork_threads - 1];
+        };
+
+        pool the_pool;
+
+        void pool_main(void* p)
+        {
+            atomic<uint32_t>& go = ((pool_thread*)p)->go;
+            for (uint32_t seen = 0;; seen++)
+            {
+                go.wait(seen, memory_order_acquire);
+                the_pool.job(the_pool.ctx);
+                if (the_pool.running.fetch_sub(1, memory_order_acq_rel) == 1)
+                    the_pool.running.notify_one();
+            }
+        }
+    } // namespace
+
+    void fork_join_run(void (*job)(void*) noexcept, void* ctx, size_t helpers) noexcept
+    {
+        pool& p = the_pool;
+        if (helpers > max_fork_threads - 1)
+            helpers = max_fork_threads - 1;
+        if (helpers == 0 || p.busy.exchange(true, memory_order_acquire))
+            return job(ctx);
+
+        while (p.started < helpers && thread_spawn(pool_main, &p.threads[p.started]) != nullptr)
+            p.started++;
+        if (helpers > p.started)
+            helpers = p.started;
+
+        // the job is published by the release on each go word, and every pool thread that ran the last one is
+        // done with it, since running reached 0 before busy was let go
+        p.job = job;
+        p.ctx = ctx;
+        p.running.store(helpers, memory_order_relaxed);
+        for (size_t i = 0; i < helpers; i++)
+        {
+            p.threads[i].go.fetch_add(1, memory_order_release);
+            p.threads[i].go.notify_one();
+        }
+
+        job(ctx);
+        for (uint32_t left; (left = p.running.load(memory_order_acquire)) != 0;)
+            p.running.wait(left, memory_order_acquire);
+        p.busy.store(false, memory_order_release);
+    }
+} // namespace std::detail
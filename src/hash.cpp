@@ -0,0 +1,55 @@
+#include "../bits/hash.h"
+
+namespace std::detail
+{
+    namespace
+    {
+        // multiplies and folds the 128-bit product, the mixing step of wyhash
+        inline uint64_t mum(uint64_t a, uint64_t b)
+        {
+#ifdef __SIZEOF_INT128__
+            __uint128_t r = (__uint128_t)a * b;
+            return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+            uint64_t r = a * b;
+            return r ^ (r >> 32) ^ (a >> 29) * b;
+#endif
+        }
+
+        inline uint64_t read64(const unsigned char* p)
+        {
+            uint64_t v;
+            __builtin_memcpy(&v, p, 8);
+            return v;
+        }
+
+        constexpr uint64_t K0 = 0xa0761d6478bd642f;
+        constexpr uint64_t K1 = 0xe7037ed1a0b428db;
+        constexpr uint64_t K2 = 0x8ebc6af09c88c6e3;
+    } // namespace
+
+    size_t hash_bytes(const void* data, size_t n, size_t seed)
+    {
+        const unsigned char* p = (const unsigned char*)data;
+        uint64_t h = mum(seed ^ K0, n ^ K1);
+
+        for (; n >= 16; p += 16, n -= 16)
+            h = mum(read64(p) ^ K1, read64(p + 8) ^ h);
+
+        if (n >= 8)
+        {
+            h = mum(read64(p) ^ K2, h ^ K0);
+            p += 8;
+            n -= 8;
+        }
+
+        if (n)
+        {
+            uint64_t tail = 0;
+            __builtin_memcpy(&tail, p, n);
+            h = mum(tail ^ K1, h ^ K2);
+        }
+
+        return mum(h, K0);
+    }
+} // namespace std::detail
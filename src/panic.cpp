@@ -1,3 +1,4 @@
+#include <hexdump.h>
 #include <panic.h>
 
 namespace std
@@ -13,6 +14,10 @@ namespace std
             printf("#%d: %p\n", i, stack_buffer[i]);
         }
 
+        // the frame of whoever called panic() and a bit of its caller's
+        printf("stack:\n");
+        hexdump(detail::putc, __builtin_frame_address(0), 0x80);
+
         detail::errors::__halt();
     }
 } // namespace std
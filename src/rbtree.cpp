@@ -0,0 +1,286 @@
+#include "../bits/rbtree.h"
+
+namespace std::detail
+{
+    namespace
+    {
+        using node = rbtree_node_base;
+
+        inline bool is_black(const node* x) { return !x || x->is_black(); }
+
+        // makes y take the place of x below x's parent (or as the root)
+        inline void replace_child(node* x, node* y, node* parent, node& header)
+        {
+            if (parent == &header)
+                header.set_parent(y);
+            else if (parent->left == x)
+                parent->left = y;
+            else
+                parent->right = y;
+        }
+
+        void rotate_left(node* x, node& header)
+        {
+            node* y = x->right;
+            x->right = y->left;
+            if (y->left)
+                y->left->set_parent(x);
+
+            node* p = x->parent();
+            y->set_parent(p);
+            replace_child(x, y, p, header);
+            y->left = x;
+            x->set_parent(y);
+        }
+
+        void rotate_right(node* x, node& header)
+        {
+            node* y = x->left;
+            x->left = y->right;
+            if (y->right)
+                y->right->set_parent(x);
+
+            node* p = x->parent();
+            y->set_parent(p);
+            replace_child(x, y, p, header);
+            y->right = x;
+            x->set_parent(y);
+        }
+    } // namespace
+
+    rbtree_node_base* rbtree_increment(const rbtree_node_base* c)
+    {
+        node* x = (node*)c;
+        if (x->right)
+            return node::minimum(x->right);
+
+        node* y = x->parent();
+        while (x == y->right)
+        {
+            x = y;
+            y = y->parent();
+        }
+
+        // x only ends up as the right child of y when climbing from the rightmost node through the root to the
+        // header, whose right child is the rightmost node again
+        return x->right != y ? y : x;
+    }
+
+    rbtree_node_base* rbtree_decrement(const rbtree_node_base* c)
+    {
+        node* x = (node*)c;
+        if (x->is_red() && x->parent()->parent() == x)
+            return x->right;
+
+        if (x->left)
+            return node::maximum(x->left);
+
+        node* y = x->parent();
+        while (x == y->left)
+        {
+            x = y;
+            y = y->parent();
+        }
+        return y;
+    }
+
+    void rbtree_insert_rebalance(bool left, rbtree_node_base* x, rbtree_node_base* parent, rbtree_node_base& header)
+    {
+        x->parent_color = (uintptr_t)parent;
+        x->left = x->right = nullptr;
+
+        if (parent == &header)
+        {
+            header.set_parent(x);
+            header.left = header.right = x;
+        }
+        else if (left)
+        {
+            parent->left = x;
+            if (parent == header.left)
+                header.left = x;
+        }
+        else
+        {
+            parent->right = x;
+            if (parent == header.right)
+                header.right = x;
+        }
+
+        while (x != header.parent() && x->parent()->is_red())
+        {
+            node* p = x->parent();
+            node* g = p->parent();
+            if (p == g->left)
+            {
+                node* u = g->right;
+                if (u && u->is_red())
+                {
+                    p->set_black();
+                    u->set_black();
+                    g->set_red();
+                    x = g;
+                    continue;
+                }
+
+                if (x == p->right)
+                {
+                    rotate_left(p, header);
+                    x = p;
+                    p = x->parent();
+                }
+                p->set_black();
+                g->set_red();
+                rotate_right(g, header);
+            }
+            else
+            {
+                node* u = g->left;
+                if (u && u->is_red())
+                {
+                    p->set_black();
+                    u->set_black();
+                    g->set_red();
+                    x = g;
+                    continue;
+                }
+
+                if (x == p->left)
+                {
+                    rotate_right(p, header);
+                    x = p;
+                    p = x->parent();
+                }
+                p->set_black();
+                g->set_red();
+                rotate_left(g, header);
+            }
+        }
+
+        header.parent()->set_black();
+    }
+
+    void rbtree_erase_rebalance(rbtree_node_base* z, rbtree_node_base& header)
+    {
+        // x takes the place of the node that is physically removed, which is z itself or, if z has two children,
+        // its successor y (which is then moved into z's place, taking z's color)
+        node* x;
+        node* x_parent;
+        bool removed_black;
+
+        if (z->left && z->right)
+        {
+            node* y = node::minimum(z->right);
+            x = y->right;
+            removed_black = y->is_black();
+
+            z->left->set_parent(y);
+            y->left = z->left;
+            if (y != z->right)
+            {
+                x_parent = y->parent();
+                if (x)
+                    x->set_parent(x_parent);
+                x_parent->left = x;
+                y->right = z->right;
+                z->right->set_parent(y);
+            }
+            else
+                x_parent = y;
+
+            node* p = z->parent();
+            replace_child(z, y, p, header);
+            y->parent_color = z->parent_color;
+        }
+        else
+        {
+            x = z->left ? z->left : z->right;
+            x_parent = z->parent();
+            removed_black = z->is_black();
+            if (x)
+                x->set_parent(x_parent);
+            replace_child(z, x, x_parent, header);
+
+            if (header.left == z)
+                header.left = x ? node::minimum(x) : x_parent;
+            if (header.right == z)
+                header.right = x ? node::maximum(x) : x_parent;
+        }
+
+        if (!removed_black)
+            return;
+
+        while (x != header.parent() && is_black(x))
+        {
+            if (x == x_parent->left)
+            {
+                node* w = x_parent->right;
+                if (w->is_red())
+                {
+                    w->set_black();
+                    x_parent->set_red();
+                    rotate_left(x_parent, header);
+                    w = x_parent->right;
+                }
+
+                if (is_black(w->left) && is_black(w->right))
+                {
+                    w->set_red();
+                    x = x_parent;
+                    x_parent = x_parent->parent();
+                    continue;
+                }
+
+                if (is_black(w->right))
+                {
+                    w->left->set_black();
+                    w->set_red();
+                    rotate_right(w, header);
+                    w = x_parent->right;
+                }
+                w->set_color_of(x_parent);
+                x_parent->set_black();
+                if (w->right)
+                    w->right->set_black();
+                rotate_left(x_parent, header);
+                break;
+            }
+            else
+            {
+                node* w = x_parent->left;
+                if (w->is_red())
+                {
+                    w->set_black();
+                    x_parent->set_red();
+                    rotate_right(x_parent, header);
+                    w = x_parent->left;
+                }
+
+                if (is_black(w->left) && is_black(w->right))
+                {
+                    w->set_red();
+                    x = x_parent;
+                    x_parent = x_parent->parent();
+                    continue;
+                }
+
+                if (is_black(w->left))
+                {
+                    w->right->set_black();
+                    w->set_red();
+                    rotate_left(w, header);
+                    w = x_parent->left;
+                }
+                w->set_color_of(x_parent);
+                x_parent->set_black();
+                if (w->left)
+                    w->left->set_black();
+                rotate_right(x_parent, header);
+                break;
+            }
+        }
+
+        if (x)
+            x->set_black();
+    }
+} // namespace std::detail
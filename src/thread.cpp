@@ -0,0 +1,83 @@
+#include "../bits/user_implement.h"
+#include <cstddef>
+#include <cstdint>
+
+#if __has_include(<pthread.h>) && __has_include(<unistd.h>)
+#include <pthread.h>
+#include <unistd.h>
+
+namespace std::detail
+{
+    namespace
+    {
+        struct pthread_handle
+        {
+            pthread_t thread;
+            void (*fn)(void*);
+            void* arg;
+        };
+
+        void* pthread_start(void* p)
+        {
+            pthread_handle* h = (pthread_handle*)p;
+            h->fn(h->arg);
+            return nullptr;
+        }
+    } // namespace
+
+    [[gnu::weak]] void* thread_spawn(void (*fn)(void*), void* arg)
+    {
+        pthread_handle* h = (pthread_handle*)detail::malloc(sizeof(pthread_handle));
+        if (h == nullptr)
+            return nullptr;
+        h->fn = fn;
+        h->arg = arg;
+        if (pthread_create(&h->thread, nullptr, pthread_start, h) != 0)
+        {
+            detail::free(h);
+            return nullptr;
+        }
+        return h;
+    }
+
+    [[gnu::weak]] void thread_join(void* thread)
+    {
+        pthread_handle* h = (pthread_handle*)thread;
+        pthread_join(h->thread, nullptr);
+        detail::free(h);
+    }
+
+    // sysconf reads sysfs, so the answer is kept
+    [[gnu::weak]] size_t cpu_count()
+    {
+        static size_t count = 0;
+        size_t n = __atomic_load_n(&count, __ATOMIC_RELAXED);
+        if (n == 0)
+        {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            n = online > 0 ? (size_t)online : 1;
+            __atomic_store_n(&count, n, __ATOMIC_RELAXED);
+        }
+        return n;
+    }
+} // namespace std::detail
+#endif
+
+#if __has_include(<linux/futex.h>) && __has_include(<sys/syscall.h>) && __has_include(<unistd.h>)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace std::detail
+{
+    [[gnu::weak]] void futex_wait(const volatile uint32_t* addr, uint32_t expected)
+    {
+        syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    [[gnu::weak]] void futex_wake(const volatile uint32_t* addr, int count)
+    {
+        syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+} // namespace std::detail
+#endif